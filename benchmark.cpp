@@ -0,0 +1,214 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+
+/**
+ * Benchmark firmware.
+ *
+ * Measures how many cpu cycles each animation and rendering path of the
+ * firmware takes for the real display of 9 matrices and 60 leds, and compares
+ * the worst case with a budget. The budgets divide the 160000 cycles of a 50 Hz
+ * frame at 8 MHz over the paths that can run in the same frame.
+ *
+ * Every result is written as a line of text to GPIOR0, which simavr prints as
+ * its console. When done, the firmware sleeps with interrupts disabled, which
+ * makes simavr stop. "make -f Makefile.avr run-benchmark" runs it and fails if
+ * any line reports FAIL.
+ */
+#define main wifimatrix_main
+#include "wifimatrix.cpp"
+#undef main
+
+#include <avr/sleep.h>
+
+#ifdef BENCHMARK_SIMAVR
+#include <simavr/avr/avr_mcu_section.h>
+AVR_MCU( F_CPU, "atmega328p");
+AVR_MCU_SIMAVR_CONSOLE( &GPIOR0);
+#endif
+
+namespace
+{
+    void print( const char *text)
+    {
+        while (*text) GPIOR0 = *text++;
+    }
+
+    void print( uint32_t value)
+    {
+        char digits[11];
+        char *position = digits + sizeof digits;
+        *--position = 0;
+        do
+        {
+            *--position = '0' + value % 10;
+            value /= 10;
+        }
+        while (value);
+        print( position);
+    }
+
+    /// Cycles that a measurement of nothing takes.
+    uint32_t overhead = 0;
+
+    /**
+     * Run a piece of code a number of times and report the mean and the
+     * worst case cycle counts. A budget of zero means that the path is only
+     * reported.
+     *
+     * Returns false if the worst case exceeds the budget.
+     */
+    template< typename function_type>
+    bool measure( const char *name, uint16_t repeat, uint32_t budget, function_type function)
+    {
+        uint32_t total = 0;
+        uint32_t worst = 0;
+        for (uint16_t count = 0; count < repeat; ++count)
+        {
+            const auto start = Timer::GetTicks();
+            function();
+            auto cycles = Timer::GetTicks() - start;
+            cycles = cycles > overhead ? cycles - overhead : 0;
+            total += cycles;
+            if (cycles > worst) worst = cycles;
+        }
+
+        const bool ok = not budget or worst <= budget;
+        print( name);
+        print( ": mean ");
+        print( total / repeat);
+        print( ", worst ");
+        print( worst);
+        if (budget)
+        {
+            print( ", budget ");
+            print( budget);
+            print( ok ? " OK" : " FAIL");
+        }
+        print( "\n");
+        return ok;
+    }
+
+    void no_operation()
+    {
+        asm volatile("");
+    }
+
+    const char long_text[] =
+            "The quick brown fox jumps over the lazy dog, "
+            "while the matrix scrolls this text from right to left.";
+}
+
+int main()
+{
+    glyphs.build();
+    seed_random( 1);
+
+    // let timer 1 count cpu cycles instead of 1024-cycle ticks.
+    TCCR1B = 1;
+    sei();
+
+    overhead = 0xffffffff;
+    for (uint8_t count = 0; count < 10; ++count)
+    {
+        const auto start = Timer::GetTicks();
+        no_operation();
+        const auto cycles = Timer::GetTicks() - start;
+        if (cycles < overhead) overhead = cycles;
+    }
+
+    bool ok = true;
+
+    int16_t offset = 0;
+    ok &= measure( "render_string", 40, 30000, [&]()
+        {
+            display.clear();
+            render_string( long_text, offset);
+            offset -= 8;
+        });
+
+    text_columns.store( long_text, sizeof long_text);
+    show_text();
+    ok &= measure( "scroll", 100, 15000, []()
+        {
+            scroller.step();
+            display.clear();
+            scroller.render( display);
+        });
+
+    snowflakes_type<display_type> snowflakes;
+    ok &= measure( "snow", 100, 20000, [&]()
+        {
+            snowflakes.step();
+            snowflakes.render( display);
+        });
+
+    ok &= measure( "fireworks", 200, 30000, []()
+        {
+            rockets.step( true, g.fireworks);
+            rockets.render( display);
+        });
+
+    ok &= measure( "droplets", 100, 20000, []()
+        {
+            droplet_animate( g.leds);
+        });
+
+    for (uint8_t led = 0; led < flare_count; ++led)
+    {
+        g.flares.start( g.flares.find( led * 3), led * 3, flare::BackAndForthForward,
+                ws2811::rgb{ 0, 0, 0}, ws2811::rgb{ 255, 128, 0}, 16 + led, easing::Sine);
+    }
+    ok &= measure( "flares", 100, 20000, []()
+        {
+            g.flares.update( g.leds);
+        });
+
+    // every digit of every matrix changes in every frame.
+    uint8_t pattern = 0x55;
+    ok &= measure( "transmit", 20, 80000, [&]()
+        {
+            display.clear();
+            for (uint8_t column = 0; column < display_type::column_count; ++column)
+            {
+                display.push_column( pattern);
+            }
+            pattern = ~pattern;
+            display.transmit();
+        });
+
+    ok &= measure( "send_leds", 20, 20000, []()
+        {
+            send_leds();
+        });
+
+    // the random generator, against the modulo that it replaced.
+    volatile uint16_t sink;
+    measure( "my_rand", 100, 0, [&]()
+        {
+            sink = my_rand();
+        });
+    measure( "no_more_than", 100, 0, [&]()
+        {
+            sink = no_more_than( display_type::column_count * 16);
+        });
+    measure( "my_rand % range", 100, 0, [&]()
+        {
+            sink = my_rand() % (display_type::column_count * 16);
+        });
+    measure( "plusminus", 100, 0, [&]()
+        {
+            sink = plusminus( 10);
+        });
+
+    print( ok ? "benchmark OK\n" : "benchmark FAIL\n");
+
+    cli();
+    sleep_enable();
+    sleep_cpu();
+    return 0;
+}
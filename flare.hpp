@@ -9,7 +9,17 @@
 #define FLARE_HPP_
 #include <ws2811/rgb.h>
 #include <ws2811/rgb_operators.hpp>
+#include "easing.hpp"
 
+template< uint8_t count, uint8_t led_count>
+class flare_pool;
+
+/**
+ * A flare fades a single led between two colors, once or back and forth.
+ *
+ * Mode, easing curve and the fractional step are packed into a single byte
+ * to keep the flare small.
+ */
 class flare
 {
 public:
@@ -22,12 +32,21 @@ public:
         ModeCount // end of sequence
     };
 
+    static_assert( ModeCount <= 4, "modes must fit in m_mode");
+    static_assert( easing::CurveCount <= 4, "curves must fit in m_curve");
+
+    flare()
+    :m_mode{ Off}, m_curve{ easing::Linear}, m_accumulator{ 0}
+    {
+    }
+
     template< size_t size>
     bool render( ws2811::rgb (&leds)[size]) const
     {
         if (m_mode == Off or size <= m_led_index) return false;
 
-        leds[m_led_index] = ws2811::fade( m_scale, m_color_from, m_color_to);
+        leds[m_led_index] = ws2811::fade(
+                easing::apply( static_cast<easing::Curve>( m_curve), m_scale), m_color_from, m_color_to);
 
         return true;
     }
@@ -52,67 +71,81 @@ public:
             Mode new_mode,
             const ws2811::rgb &from,
             const ws2811::rgb &to,
-            uint8_t new_speed)
+            uint8_t new_speed,
+            easing::Curve new_curve = easing::Linear)
     {
         m_led_index = new_index;
         m_mode = new_mode;
         m_color_from = from;
         m_color_to = to;
         m_speed = new_speed;
+        m_curve = new_curve;
         m_accumulator = 0;
         m_scale = 0;
     }
 
 
 
+    /**
+     * Advance the flare by m_speed/threshold scale steps.
+     *
+     * The amount of steps is computed at once instead of one step at a time,
+     * so the time this takes does not depend on the speed.
+     */
     void step()
     {
-        m_accumulator += m_speed;
-        while (m_accumulator >= threshold)
+        const uint16_t accumulator = m_accumulator + m_speed;
+        const uint8_t steps = accumulator / threshold;
+        m_accumulator = accumulator % threshold;
+        if (not steps) return;
+
+        if (m_mode == OneShot)
         {
-            m_accumulator -= threshold;
-            if (m_mode == BackAndForthForward)
+            // the flare switches off on the first step after reaching 255.
+            if (steps > 255 - m_scale)
             {
-                if (m_scale != 255)
-                {
-                    if (++m_scale == 255)
-                    {
-                        m_mode = BackAndForthBackward;
-                    }
-                }
+                m_scale = 255;
+                m_mode = Off;
             }
-            else if (m_mode == OneShot)
+            else
             {
-                if (m_scale != 255)
-                {
-                    ++m_scale;
-                }
-                else
-                {
-                    m_mode = Off;
-                }
+                m_scale += steps;
             }
-            else if (m_mode == BackAndForthBackward)
+        }
+        else if (m_mode == BackAndForthForward or m_mode == BackAndForthBackward)
+        {
+            // position in a period of going up from 0 to 255 and back down again.
+            constexpr uint16_t period = 2 * 255;
+            uint16_t position = m_mode == BackAndForthForward ? m_scale : period - m_scale;
+            position += steps;
+            if (position >= period) position -= period;
+
+            if (position < 255)
             {
-                if (m_scale != 0)
-                {
-                    if (--m_scale == 0)
-                    {
-                        m_mode = BackAndForthForward;
-                    }
-                }
+                m_mode = BackAndForthForward;
+                m_scale = position;
+            }
+            else
+            {
+                m_mode = BackAndForthBackward;
+                m_scale = period - position;
             }
         }
     }
 
 private:
-    Mode        m_mode = Off;
+    template< uint8_t, uint8_t>
+    friend class flare_pool;
+
     ws2811::rgb m_color_from{0,0,0};
     ws2811::rgb m_color_to{0,0,0};
     uint8_t     m_scale = 0;
     uint8_t     m_led_index = 0;
-    uint16_t    m_accumulator;
-    uint8_t     m_speed;
+    uint8_t     m_speed = 0;
+    uint8_t     m_mode:2;           // a Mode
+    uint8_t     m_curve:2;          // an easing::Curve
+    uint8_t     m_accumulator:4;    // fraction of a scale step
+    uint8_t     m_next = 0;         // next flare in the list of a flare_pool
     static constexpr uint16_t threshold = 16;
 };
 
@@ -0,0 +1,212 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef FLARE_POOL_HPP_
+#define FLARE_POOL_HPP_
+#include "flare.hpp"
+
+/**
+ * A fixed set of flares that animate a strip of led_count leds.
+ *
+ * Every led is animated by at most one flare. A bitmap, one bit per led, tells
+ * whether a led is animated. Each flare is either on the list of active flares
+ * or on the list of free flares. Both lists are linked through the flares
+ * themselves. Finding the flare of an animated led and updating the leds
+ * every frame therefore only visit the flares that are actually animating,
+ * and finding a flare for a led that is not animated takes constant time.
+ */
+template< uint8_t count, uint8_t led_count>
+class flare_pool
+{
+public:
+    static constexpr uint8_t none = 0xff;
+    static_assert( count < none, "flare indices must be smaller than none");
+
+    flare_pool()
+    {
+        stop_all();
+    }
+
+    /**
+     * Return the index of the flare that animates the given led, or
+     * else the index of a free flare. Returns none if all flares are busy.
+     */
+    uint8_t find( uint8_t led_index) const
+    {
+        const auto index = flare_of_led( led_index);
+        return index != none ? index : m_free;
+    }
+
+    /**
+     * (Re)start a flare on a led. A different flare that was
+     * animating the same led is stopped.
+     *
+     * Restarting an active flare, or starting the flare that find() returned,
+     * takes constant time. Other flares are first looked up in their list.
+     */
+    void start(
+            uint8_t index,
+            uint8_t led_index,
+            flare::Mode mode,
+            const ws2811::rgb &from,
+            const ws2811::rgb &to,
+            uint8_t speed,
+            easing::Curve curve)
+    {
+        if (index >= count or led_index >= led_count) return;
+
+        const auto previous = flare_of_led( led_index);
+        if (previous != none and previous != index)
+        {
+            release( previous);
+        }
+
+        auto &f = m_flares[index];
+        if (mode == flare::Off)
+        {
+            release( index);
+            return;
+        }
+
+        if (f.is_active())
+        {
+            // the flare stays on the active list, but may move to another led.
+            mark( f.led_index(), false);
+        }
+        else
+        {
+            unlink( m_free, index);
+            f.m_next = m_active;
+            m_active = index;
+        }
+
+        f.setup( led_index, mode, from, to, speed, curve);
+        mark( led_index, true);
+    }
+
+    void stop_all()
+    {
+        for (auto &bits : m_animated)
+        {
+            bits = 0;
+        }
+
+        m_active = none;
+        m_free = none;
+        for (uint8_t index = count; index; --index)
+        {
+            m_flares[index - 1].stop();
+            m_flares[index - 1].m_next = m_free;
+            m_free = index - 1;
+        }
+    }
+
+    /**
+     * Step and render all active flares. Flares that have finished are
+     * moved to the free list.
+     *
+     * Returns true if any led was changed.
+     */
+    template< size_t size>
+    bool update( ws2811::rgb (&leds)[size])
+    {
+        bool changed = false;
+        uint8_t *link = &m_active;
+        while (*link != none)
+        {
+            const auto index = *link;
+            auto &f = m_flares[index];
+            f.step();
+            if (f.render( leds))
+            {
+                changed = true;
+                link = &f.m_next;
+            }
+            else
+            {
+                // unlink this flare and put it on the free list.
+                mark( f.led_index(), false);
+                *link = f.m_next;
+                f.m_next = m_free;
+                m_free = index;
+            }
+        }
+        return changed;
+    }
+
+private:
+    /**
+     * Return the index of the flare that animates a led, or none.
+     */
+    uint8_t flare_of_led( uint8_t led_index) const
+    {
+        if (led_index >= led_count or not (m_animated[led_index / 8] & (1 << (led_index % 8))))
+        {
+            return none;
+        }
+
+        uint8_t index = m_active;
+        while (index != none and m_flares[index].led_index() != led_index)
+        {
+            index = m_flares[index].m_next;
+        }
+        return index;
+    }
+
+    void mark( uint8_t led_index, bool animated)
+    {
+        const uint8_t bit = 1 << (led_index % 8);
+        if (animated)
+        {
+            m_animated[led_index / 8] |= bit;
+        }
+        else
+        {
+            m_animated[led_index / 8] &= ~bit;
+        }
+    }
+
+    /**
+     * Stop a flare and move it from the active list to the free list.
+     */
+    void release( uint8_t index)
+    {
+        auto &f = m_flares[index];
+        if (not f.is_active()) return;
+
+        unlink( m_active, index);
+        mark( f.led_index(), false);
+        f.stop();
+        f.m_next = m_free;
+        m_free = index;
+    }
+
+    /**
+     * Remove a flare from a list. This takes constant time if the
+     * flare is at the head of the list.
+     */
+    void unlink( uint8_t &head, uint8_t index)
+    {
+        uint8_t *link = &head;
+        while (*link != none)
+        {
+            if (*link == index)
+            {
+                *link = m_flares[index].m_next;
+                return;
+            }
+            link = &m_flares[*link].m_next;
+        }
+    }
+
+    flare   m_flares[count];
+    uint8_t m_animated[(led_count + 7) / 8];    ///< one bit per led that a flare animates
+    uint8_t m_active = none;
+    uint8_t m_free = none;
+};
+
+#endif /* FLARE_POOL_HPP_ */
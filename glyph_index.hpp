@@ -0,0 +1,151 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef GLYPH_INDEX_HPP_
+#define GLYPH_INDEX_HPP_
+#include <avr_utilities/font5x8.hpp>
+#include <avr/pgmspace.h>
+#include <stddef.h>
+
+/**
+ * Widths and positions of the glyphs of printable ascii characters in the 5x8 font.
+ *
+ * The font stores its glyphs as null-terminated runs of column bytes in
+ * program memory, so font5x8::find_character() has to scan the font to
+ * find a character. This class scans the font once, at startup, and keeps the
+ * width of every printable character in half a byte. That is enough to skip
+ * characters without reading their columns.
+ *
+ * If the glyphs follow each other in the font in ascii order, separated by
+ * the same amount of bytes, a glyph is found by adding the widths of the
+ * preceding glyphs to the nearest of a few stored glyph positions. Otherwise, find()
+ * falls back to scanning the font.
+ *
+ * The font lives in a separate library and is not available to constexpr
+ * functions, so the tables are filled at startup by calling build(). Together
+ * they take 60 bytes of RAM.
+ */
+class glyph_index
+{
+public:
+    static constexpr char first = '!';
+    static constexpr char last  = '~';
+
+    void build()
+    {
+        bool laid_out = true;
+        const uint8_t *previous_end = nullptr;
+        ptrdiff_t gap = 0;
+        for (uint8_t index = 0; index < count; ++index)
+        {
+            const uint8_t *glyph = font5x8::find_character( first + index);
+            uint8_t width = 0;
+            while (glyph and width < wide and pgm_read_byte( glyph + width))
+            {
+                ++width;
+            }
+
+            m_widths[index / 2] = index % 2 ?
+                    (m_widths[index / 2] & 0x0f) | (width << 4) : width;
+
+            if (index % stride == 0)
+            {
+                m_positions[index / stride] = glyph;
+            }
+
+            // all glyphs must follow the previous one at the same distance.
+            if (not glyph or width == wide)
+            {
+                laid_out = false;
+            }
+            else if (laid_out and index == 1)
+            {
+                gap = glyph - previous_end;
+            }
+            else if (laid_out and index > 1 and glyph - previous_end != gap)
+            {
+                laid_out = false;
+            }
+            previous_end = glyph + width;
+        }
+
+        m_gap = (laid_out and gap > 0 and gap < 16) ? gap : 0;
+    }
+
+    /**
+     * Return a pointer in program memory to the null-terminated columns
+     * of the given character.
+     */
+    const uint8_t *find( char character) const
+    {
+        if (m_gap == 0 or character < first or character > last)
+        {
+            return font5x8::find_character( character);
+        }
+
+        const uint8_t index = character - first;
+        const uint8_t *glyph = m_positions[index / stride];
+        for (uint8_t preceding = index - index % stride; preceding != index; ++preceding)
+        {
+            glyph += width( preceding) + m_gap;
+        }
+        return glyph;
+    }
+
+    /**
+     * Return whether find() uses the stored glyph positions instead of
+     * scanning the font.
+     */
+    bool is_direct() const
+    {
+        return m_gap != 0;
+    }
+
+    /**
+     * Return the amount of columns that a character occupies when rendered,
+     * including the empty column that separates it from the next character.
+     */
+    uint8_t columns( char character) const
+    {
+        if (character == ' ') return 2;
+
+        if (character >= first and character <= last)
+        {
+            const uint8_t result = width( character - first);
+            if (result != wide) return result + 1;
+        }
+
+        uint8_t count = 1;
+        auto column = font5x8::find_character( character);
+        while (column and pgm_read_byte( column++))
+        {
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    static constexpr uint8_t count = last - first + 1;
+
+    /// Glyph positions are stored for every stride-th character.
+    static constexpr uint8_t stride = 16;
+
+    /// Width that is stored for glyphs of this width or wider, which must be measured.
+    static constexpr uint8_t wide = 15;
+
+    uint8_t width( uint8_t index) const
+    {
+        const uint8_t widths = m_widths[index / 2];
+        return index % 2 ? widths >> 4 : widths & 0x0f;
+    }
+
+    uint8_t        m_widths[(count + 1) / 2];
+    const uint8_t *m_positions[(count + stride - 1) / stride];
+    uint8_t        m_gap = 0;  ///< bytes from the end of a glyph to the next glyph, 0 if unknown
+};
+
+#endif /* GLYPH_INDEX_HPP_ */
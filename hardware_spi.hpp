@@ -0,0 +1,43 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef HARDWARE_SPI_HPP_
+#define HARDWARE_SPI_HPP_
+#include <avr/io.h>
+#include <stdint.h>
+
+/**
+ * Transmit-only spi through the spi hardware of the atmega328, as an alternative
+ * to bitbanged_spi for the matrix_display.
+ *
+ * Data is sent on MOSI (B3) and clocked on SCK (B5) at half the cpu clock, so
+ * a byte takes 16 cpu cycles. That is less than the overhead of entering and
+ * leaving an interrupt handler, which is why this class waits for each byte instead
+ * of using the spi-complete interrupt.
+ *
+ * The spi hardware turns MISO (B4) into an input when it is enabled, so the
+ * chip select of the display cannot be on B4 when using this class. SS (B2) is
+ * made an output to keep the spi hardware in master mode, which also makes it a
+ * good choice for the chip select.
+ */
+struct hardware_spi
+{
+    static void init()
+    {
+        DDRB |= _BV( DDB2) | _BV( DDB3) | _BV( DDB5);
+        SPCR = _BV( SPE) | _BV( MSTR);
+        SPSR = _BV( SPI2X);
+    }
+
+    static void transmit( uint8_t value)
+    {
+        SPDR = value;
+        while (not (SPSR & _BV( SPIF))) /* wait */;
+    }
+};
+
+#endif /* HARDWARE_SPI_HPP_ */
@@ -0,0 +1,197 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <host/board.hpp>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include <deque>
+#include <map>
+#include <utility>
+
+volatile uint8_t PORTB, DDRB, PINB, PORTC, DDRC, PINC, PORTD, DDRD, PIND;
+volatile uint8_t SPCR, SPSR;
+host::spi_data_register SPDR;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+volatile uint16_t TCNT1;
+volatile uint8_t GPIOR0;
+
+// defined by timer.cpp, if it is linked in.
+extern "C" void TIMER1_OVF_vect() __attribute__((weak));
+
+namespace host
+{
+    namespace
+    {
+        struct board_state
+        {
+            uint32_t                                         ticks = 0;
+            bool                                             interrupts = false;
+            std::map<std::pair<char, uint8_t>, bool>         pins;
+            std::vector<pin_observer>                        pin_observers;
+            std::vector<spi_observer>                        spi_observers;
+            std::vector<interrupt_observer>                  interrupt_observers;
+            std::vector<strip_observer>                      strip_observers;
+            std::vector<poll_observer>                       poll_observers;
+            std::vector<publish_observer>                    publish_observers;
+            std::vector<std::string>                         subscriptions;
+            std::deque<std::pair<std::string, std::string>>  messages;
+            bool                                             is_setup = false;
+        };
+
+        board_state &board()
+        {
+            static board_state state;
+            return state;
+        }
+
+        bool matches( const std::string &subscription, const std::string &topic)
+        {
+            if (not subscription.empty() and subscription.back() == '#')
+            {
+                return topic.compare( 0, subscription.size() - 1, subscription, 0, subscription.size() - 1) == 0;
+            }
+            return subscription == topic;
+        }
+    }
+
+    spi_data_register &spi_data_register::operator=( uint8_t value)
+    {
+        last = value;
+        spi_byte( value);
+        SPSR |= _BV( SPIF);
+        return *this;
+    }
+
+    void advance_ticks( uint16_t ticks)
+    {
+        board().ticks += ticks;
+        while (ticks--)
+        {
+            if (not ++TCNT1 and TIMER1_OVF_vect) TIMER1_OVF_vect();
+        }
+    }
+
+    uint32_t ticks()
+    {
+        return board().ticks;
+    }
+
+    void write_pin( char port, uint8_t bit, bool value)
+    {
+        board().pins[{ port, bit}] = value;
+        for (auto &observer : board().pin_observers) observer( port, bit, value);
+    }
+
+    bool read_pin( char port, uint8_t bit)
+    {
+        return board().pins[{ port, bit}];
+    }
+
+    void observe_pins( pin_observer observer)
+    {
+        board().pin_observers.push_back( observer);
+    }
+
+    void observe_spi( spi_observer observer)
+    {
+        board().spi_observers.push_back( observer);
+    }
+
+    void spi_byte( uint8_t byte)
+    {
+        for (auto &observer : board().spi_observers) observer( byte);
+    }
+
+    bool interrupts_enabled()
+    {
+        return board().interrupts;
+    }
+
+    void set_interrupts( bool enabled)
+    {
+        board().interrupts = enabled;
+        for (auto &observer : board().interrupt_observers) observer( enabled);
+    }
+
+    void observe_interrupts( interrupt_observer observer)
+    {
+        board().interrupt_observers.push_back( observer);
+    }
+
+    void observe_strip( strip_observer observer)
+    {
+        board().strip_observers.push_back( observer);
+    }
+
+    void strip_send( const void *bytes, uint16_t size, uint8_t pin)
+    {
+        const auto begin = static_cast<const uint8_t *>( bytes);
+        const strip_write write{ board().ticks, pin, board().interrupts, { begin, begin + size}};
+        for (auto &observer : board().strip_observers) observer( write);
+    }
+
+    void mqtt_setup()
+    {
+        board().is_setup = true;
+    }
+
+    bool mqtt_is_setup()
+    {
+        return board().is_setup;
+    }
+
+    void mqtt_subscribe( const std::string &topic)
+    {
+        board().subscriptions.push_back( topic);
+    }
+
+    void mqtt_publish( const std::string &topic, const std::string &message)
+    {
+        for (auto &observer : board().publish_observers) observer( topic, message);
+        for (const auto &subscription : board().subscriptions)
+        {
+            if (matches( subscription, topic))
+            {
+                mqtt_deliver( topic, message);
+                break;
+            }
+        }
+    }
+
+    void mqtt_deliver( const std::string &topic, const std::string &message)
+    {
+        board().messages.emplace_back( topic, message);
+    }
+
+    bool mqtt_receive( std::string &topic, std::string &message)
+    {
+        for (auto &observer : board().poll_observers) observer();
+
+        auto &messages = board().messages;
+        if (messages.empty()) return false;
+        topic = messages.front().first;
+        message = messages.front().second;
+        messages.pop_front();
+        return true;
+    }
+
+    void observe_poll( poll_observer observer)
+    {
+        board().poll_observers.push_back( observer);
+    }
+
+    void observe_publish( publish_observer observer)
+    {
+        board().publish_observers.push_back( observer);
+    }
+
+    void reset()
+    {
+        board() = board_state{};
+    }
+}
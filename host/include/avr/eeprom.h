@@ -0,0 +1,27 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in: eeprom variables are ordinary variables that start with
+// their initial value on every run.
+//
+#ifndef HOST_AVR_EEPROM_H_
+#define HOST_AVR_EEPROM_H_
+#include <stdint.h>
+
+#define EEMEM
+
+inline uint16_t eeprom_read_word( const uint16_t *address)
+{
+    return *address;
+}
+
+inline void eeprom_update_word( uint16_t *address, uint16_t value)
+{
+    *address = value;
+}
+
+#endif /* HOST_AVR_EEPROM_H_ */
@@ -0,0 +1,21 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in: interrupt vectors become plain functions that the
+// simulated board calls.
+//
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+#include <avr/io.h>
+#include <host/board.hpp>
+
+#define ISR( vector) extern "C" void vector()
+
+inline void cli() { host::set_interrupts( false); }
+inline void sei() { host::set_interrupts( true); }
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
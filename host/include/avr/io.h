@@ -0,0 +1,54 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in for the atmega328p registers that the firmware uses.
+//
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+#include <stdint.h>
+
+namespace host
+{
+    /**
+     * Stand-in for SPDR: every byte written to it is passed to the spi
+     * observers of the board and completes immediately by setting SPIF in SPSR.
+     */
+    struct spi_data_register
+    {
+        spi_data_register &operator=( uint8_t value);
+        operator uint8_t() const { return last; }
+        uint8_t last = 0;
+    };
+}
+
+extern volatile uint8_t PORTB, DDRB, PINB, PORTC, DDRC, PINC, PORTD, DDRD, PIND;
+extern volatile uint8_t SPCR, SPSR;
+extern host::spi_data_register SPDR;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+extern volatile uint16_t TCNT1;
+extern volatile uint8_t GPIOR0;
+
+#define _BV( bit) (1 << (bit))
+
+#define DDB2 2
+#define DDB3 3
+#define DDB5 5
+
+#define SPIE 7
+#define SPE 6
+#define MSTR 4
+#define SPR0 0
+#define SPIF 7
+#define SPI2X 0
+
+#define TOIE1 0
+#define TOV1 0
+
+#define TIMER1_OVF_vect host_timer1_ovf_vect
+#define SPI_STC_vect host_spi_stc_vect
+
+#endif /* HOST_AVR_IO_H_ */
@@ -0,0 +1,50 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in: program memory is ordinary memory.
+//
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR( s) (s)
+
+inline uint8_t pgm_read_byte( const void *address)
+{
+    return *static_cast<const uint8_t *>( address);
+}
+
+inline uint16_t pgm_read_word( const void *address)
+{
+    uint16_t result;
+    memcpy( &result, address, sizeof result);
+    return result;
+}
+
+inline size_t strlen_P( const char *s)
+{
+    return strlen( s);
+}
+
+inline int strncmp_P( const char *s1, const char *s2, size_t n)
+{
+    return strncmp( s1, s2, n);
+}
+
+inline char *strcpy_P( char *destination, const char *source)
+{
+    return strcpy( destination, source);
+}
+
+inline void *memcpy_P( void *destination, const void *source, size_t n)
+{
+    return memcpy( destination, source, n);
+}
+
+#endif /* HOST_AVR_PGMSPACE_H_ */
@@ -0,0 +1,16 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in: the cpu never sleeps.
+//
+#ifndef HOST_AVR_SLEEP_H_
+#define HOST_AVR_SLEEP_H_
+
+inline void sleep_enable() {}
+inline void sleep_cpu() {}
+
+#endif /* HOST_AVR_SLEEP_H_ */
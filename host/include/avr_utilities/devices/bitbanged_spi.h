@@ -0,0 +1,30 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in for the bit-banged spi of avr_utilities. Instead of toggling
+// the clock and data pins, every byte is passed to the spi observers of the
+// simulated board, most significant bit first as on the wire.
+//
+#ifndef HOST_BITBANGED_SPI_H_
+#define HOST_BITBANGED_SPI_H_
+#include <stdint.h>
+#include <host/board.hpp>
+
+template< typename pins_type>
+struct bitbanged_spi
+{
+    static void init()
+    {
+    }
+
+    static void transmit( uint8_t value)
+    {
+        host::spi_byte( value);
+    }
+};
+
+#endif /* HOST_BITBANGED_SPI_H_ */
@@ -0,0 +1,121 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in for the esp-link client of avr_utilities. Instead of talking
+// slip over a uart, the client exchanges mqtt messages with the broker of the
+// simulated board.
+//
+#ifndef HOST_ESP_LINK_CLIENT_HPP_
+#define HOST_ESP_LINK_CLIENT_HPP_
+#include <stdint.h>
+#include <string>
+#include <host/board.hpp>
+
+namespace esp_link
+{
+    struct string_ref
+    {
+        const char *buffer = nullptr;
+        uint16_t    len = 0;
+    };
+
+    /// An mqtt message: the arguments of a callback from the esp.
+    struct packet
+    {
+        std::string topic;
+        std::string message;
+    };
+
+    class packet_parser
+    {
+    public:
+        explicit packet_parser( const packet *p)
+        :p{p}
+        {}
+
+        bool get( string_ref &value)
+        {
+            if (not p or argument == 2) return false;
+            const std::string &text = argument++ ? p->message : p->topic;
+            value.buffer = text.data();
+            value.len = text.size();
+            return true;
+        }
+
+    private:
+        const packet *p;
+        uint8_t       argument = 0;
+    };
+
+    namespace mqtt
+    {
+        struct setup_type {};
+        struct subscribe_type {};
+        struct publish_type {};
+
+        constexpr setup_type     setup{};
+        constexpr subscribe_type subscribe{};
+        constexpr publish_type   publish{};
+    }
+
+    class client
+    {
+    public:
+        using callback = void (*)( const packet *, uint16_t);
+
+        struct uart_type
+        {
+            explicit uart_type( uint32_t) {}
+        };
+
+        explicit client( uart_type &) {}
+
+        bool sync()
+        {
+            return true;
+        }
+
+        /**
+         * Poll the simulated board, which advances the clock, and deliver at
+         * most one pending message to the data callback.
+         */
+        bool try_receive()
+        {
+            packet p;
+            if (not host::mqtt_receive( p.topic, p.message)) return false;
+            if (data) data( &p, 0);
+            return true;
+        }
+
+        void execute( mqtt::setup_type, callback connected, callback disconnected, callback published, callback data)
+        {
+            this->data = data;
+            host::mqtt_setup();
+        }
+
+        void execute( mqtt::subscribe_type, const char *topic, uint8_t qos)
+        {
+            host::mqtt_subscribe( topic);
+        }
+
+        void execute( mqtt::publish_type, const char *topic, const char *message, uint8_t qos, bool retain)
+        {
+            host::mqtt_publish( topic, message);
+        }
+
+        void send( const char *)
+        {
+        }
+
+    private:
+        callback data = nullptr;
+    };
+}
+
+#define IMPLEMENT_UART_INTERRUPT( uart)
+
+#endif /* HOST_ESP_LINK_CLIENT_HPP_ */
@@ -0,0 +1,14 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in: the commands are declared in client.hpp.
+//
+#ifndef HOST_ESP_LINK_COMMAND_HPP_
+#define HOST_ESP_LINK_COMMAND_HPP_
+#include "client.hpp"
+
+#endif /* HOST_ESP_LINK_COMMAND_HPP_ */
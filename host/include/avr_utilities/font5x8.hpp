@@ -0,0 +1,135 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in for the 5x8 font of avr_utilities: a proportional 5x7 font
+// for the printable ascii characters. Each glyph is stored as its character
+// code, followed by its columns, least significant bit at the top, and a
+// terminating zero. The font ends with a zero character code.
+//
+#ifndef HOST_FONT5X8_HPP_
+#define HOST_FONT5X8_HPP_
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+namespace font5x8
+{
+    const uint8_t font[] PROGMEM = {
+        '!', 0x5f, 0, // !
+        '"', 0x07, 0x07, 0, // "
+        '#', 0x14, 0x7f, 0x14, 0x7f, 0x14, 0, // #
+        '$', 0x24, 0x2a, 0x7f, 0x2a, 0x12, 0, // $
+        '%', 0x23, 0x13, 0x08, 0x64, 0x62, 0, // %
+        '&', 0x36, 0x49, 0x55, 0x22, 0x50, 0, // &
+        '\'', 0x05, 0x03, 0, // '
+        '(', 0x1c, 0x22, 0x41, 0, // (
+        ')', 0x41, 0x22, 0x1c, 0, // )
+        '*', 0x08, 0x2a, 0x1c, 0x2a, 0x08, 0, // *
+        '+', 0x08, 0x08, 0x3e, 0x08, 0x08, 0, // +
+        ',', 0x50, 0x30, 0, // ,
+        '-', 0x08, 0x08, 0x08, 0x08, 0x08, 0, // -
+        '.', 0x60, 0x60, 0, // .
+        '/', 0x20, 0x10, 0x08, 0x04, 0x02, 0, // /
+        '0', 0x3e, 0x51, 0x49, 0x45, 0x3e, 0, // 0
+        '1', 0x42, 0x7f, 0x40, 0, // 1
+        '2', 0x42, 0x61, 0x51, 0x49, 0x46, 0, // 2
+        '3', 0x21, 0x41, 0x45, 0x4b, 0x31, 0, // 3
+        '4', 0x18, 0x14, 0x12, 0x7f, 0x10, 0, // 4
+        '5', 0x27, 0x45, 0x45, 0x45, 0x39, 0, // 5
+        '6', 0x3c, 0x4a, 0x49, 0x49, 0x30, 0, // 6
+        '7', 0x01, 0x71, 0x09, 0x05, 0x03, 0, // 7
+        '8', 0x36, 0x49, 0x49, 0x49, 0x36, 0, // 8
+        '9', 0x06, 0x49, 0x49, 0x29, 0x1e, 0, // 9
+        ':', 0x36, 0x36, 0, // :
+        ';', 0x56, 0x36, 0, // ;
+        '<', 0x08, 0x14, 0x22, 0x41, 0, // <
+        '=', 0x14, 0x14, 0x14, 0x14, 0x14, 0, // =
+        '>', 0x41, 0x22, 0x14, 0x08, 0, // >
+        '?', 0x02, 0x01, 0x51, 0x09, 0x06, 0, // ?
+        '@', 0x32, 0x49, 0x79, 0x41, 0x3e, 0, // @
+        'A', 0x7e, 0x11, 0x11, 0x11, 0x7e, 0, // A
+        'B', 0x7f, 0x49, 0x49, 0x49, 0x36, 0, // B
+        'C', 0x3e, 0x41, 0x41, 0x41, 0x22, 0, // C
+        'D', 0x7f, 0x41, 0x41, 0x22, 0x1c, 0, // D
+        'E', 0x7f, 0x49, 0x49, 0x49, 0x41, 0, // E
+        'F', 0x7f, 0x09, 0x09, 0x01, 0x01, 0, // F
+        'G', 0x3e, 0x41, 0x41, 0x51, 0x32, 0, // G
+        'H', 0x7f, 0x08, 0x08, 0x08, 0x7f, 0, // H
+        'I', 0x41, 0x7f, 0x41, 0, // I
+        'J', 0x20, 0x40, 0x41, 0x3f, 0x01, 0, // J
+        'K', 0x7f, 0x08, 0x14, 0x22, 0x41, 0, // K
+        'L', 0x7f, 0x40, 0x40, 0x40, 0x40, 0, // L
+        'M', 0x7f, 0x02, 0x04, 0x02, 0x7f, 0, // M
+        'N', 0x7f, 0x04, 0x08, 0x10, 0x7f, 0, // N
+        'O', 0x3e, 0x41, 0x41, 0x41, 0x3e, 0, // O
+        'P', 0x7f, 0x09, 0x09, 0x09, 0x06, 0, // P
+        'Q', 0x3e, 0x41, 0x51, 0x21, 0x5e, 0, // Q
+        'R', 0x7f, 0x09, 0x19, 0x29, 0x46, 0, // R
+        'S', 0x46, 0x49, 0x49, 0x49, 0x31, 0, // S
+        'T', 0x01, 0x01, 0x7f, 0x01, 0x01, 0, // T
+        'U', 0x3f, 0x40, 0x40, 0x40, 0x3f, 0, // U
+        'V', 0x1f, 0x20, 0x40, 0x20, 0x1f, 0, // V
+        'W', 0x7f, 0x20, 0x18, 0x20, 0x7f, 0, // W
+        'X', 0x63, 0x14, 0x08, 0x14, 0x63, 0, // X
+        'Y', 0x03, 0x04, 0x78, 0x04, 0x03, 0, // Y
+        'Z', 0x61, 0x51, 0x49, 0x45, 0x43, 0, // Z
+        '[', 0x7f, 0x41, 0x41, 0, // [
+        '\\', 0x02, 0x04, 0x08, 0x10, 0x20, 0, // backslash
+        ']', 0x41, 0x41, 0x7f, 0, // ]
+        '^', 0x04, 0x02, 0x01, 0x02, 0x04, 0, // ^
+        '_', 0x40, 0x40, 0x40, 0x40, 0x40, 0, // _
+        '`', 0x01, 0x02, 0x04, 0, // `
+        'a', 0x20, 0x54, 0x54, 0x54, 0x78, 0, // a
+        'b', 0x7f, 0x48, 0x44, 0x44, 0x38, 0, // b
+        'c', 0x38, 0x44, 0x44, 0x44, 0x20, 0, // c
+        'd', 0x38, 0x44, 0x44, 0x48, 0x7f, 0, // d
+        'e', 0x38, 0x54, 0x54, 0x54, 0x18, 0, // e
+        'f', 0x08, 0x7e, 0x09, 0x01, 0x02, 0, // f
+        'g', 0x08, 0x14, 0x54, 0x54, 0x3c, 0, // g
+        'h', 0x7f, 0x08, 0x04, 0x04, 0x78, 0, // h
+        'i', 0x44, 0x7d, 0x40, 0, // i
+        'j', 0x20, 0x40, 0x44, 0x3d, 0, // j
+        'k', 0x7f, 0x10, 0x28, 0x44, 0, // k
+        'l', 0x41, 0x7f, 0x40, 0, // l
+        'm', 0x7c, 0x04, 0x18, 0x04, 0x78, 0, // m
+        'n', 0x7c, 0x08, 0x04, 0x04, 0x78, 0, // n
+        'o', 0x38, 0x44, 0x44, 0x44, 0x38, 0, // o
+        'p', 0x7c, 0x14, 0x14, 0x14, 0x08, 0, // p
+        'q', 0x08, 0x14, 0x14, 0x18, 0x7c, 0, // q
+        'r', 0x7c, 0x08, 0x04, 0x04, 0x08, 0, // r
+        's', 0x48, 0x54, 0x54, 0x54, 0x20, 0, // s
+        't', 0x04, 0x3f, 0x44, 0x40, 0x20, 0, // t
+        'u', 0x3c, 0x40, 0x40, 0x20, 0x7c, 0, // u
+        'v', 0x1c, 0x20, 0x40, 0x20, 0x1c, 0, // v
+        'w', 0x3c, 0x40, 0x30, 0x40, 0x3c, 0, // w
+        'x', 0x44, 0x28, 0x10, 0x28, 0x44, 0, // x
+        'y', 0x0c, 0x50, 0x50, 0x50, 0x3c, 0, // y
+        'z', 0x44, 0x64, 0x54, 0x4c, 0x44, 0, // z
+        '{', 0x08, 0x36, 0x41, 0, // {
+        '|', 0x7f, 0, // |
+        '}', 0x41, 0x36, 0x08, 0, // }
+        '~', 0x08, 0x04, 0x08, 0x10, 0x08, 0, // ~
+        0
+    };
+
+    /**
+     * Return the columns of a character, or of '?' if the font
+     * does not have the character.
+     */
+    inline const uint8_t *find_character( char character)
+    {
+        const uint8_t *glyph = font;
+        while (*glyph)
+        {
+            if (*glyph == static_cast<uint8_t>( character)) return glyph + 1;
+            while (*++glyph) /* skip columns */;
+            ++glyph;
+        }
+        return character == '?' ? nullptr : find_character( '?');
+    }
+}
+
+#endif /* HOST_FONT5X8_HPP_ */
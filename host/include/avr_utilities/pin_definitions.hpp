@@ -0,0 +1,63 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in for the pin definitions of avr_utilities. Pins are written
+// through the simulated board, so that tests can follow them.
+//
+#ifndef HOST_PIN_DEFINITIONS_HPP_
+#define HOST_PIN_DEFINITIONS_HPP_
+#include <avr/io.h>
+#include <host/board.hpp>
+
+namespace pin_definitions
+{
+    struct null_pin_type {};
+
+    template< char port_name, uint8_t bit_number>
+    struct pin_type
+    {
+        static constexpr char    port = port_name;
+        static constexpr uint8_t bit = bit_number;
+    };
+}
+
+#define PIN_TYPE( port, bit) pin_definitions::pin_type< #port[0], bit>
+
+template< char port, uint8_t bit>
+void set( pin_definitions::pin_type< port, bit> &)
+{
+    host::write_pin( port, bit, true);
+}
+
+template< char port, uint8_t bit>
+void clear( pin_definitions::pin_type< port, bit> &)
+{
+    host::write_pin( port, bit, false);
+}
+
+template< char port, uint8_t bit>
+void toggle( pin_definitions::pin_type< port, bit> &)
+{
+    host::write_pin( port, bit, not host::read_pin( port, bit));
+}
+
+template< char port, uint8_t bit>
+bool read( pin_definitions::pin_type< port, bit> &)
+{
+    return host::read_pin( port, bit);
+}
+
+template< char port, uint8_t bit>
+void make_output( pin_definitions::pin_type< port, bit> &)
+{
+}
+
+inline void set( pin_definitions::null_pin_type &) {}
+inline void clear( pin_definitions::null_pin_type &) {}
+inline void make_output( pin_definitions::null_pin_type &) {}
+
+#endif /* HOST_PIN_DEFINITIONS_HPP_ */
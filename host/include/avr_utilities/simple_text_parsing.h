@@ -0,0 +1,47 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in for the text parsing functions of avr_utilities.
+//
+#ifndef HOST_SIMPLE_TEXT_PARSING_H_
+#define HOST_SIMPLE_TEXT_PARSING_H_
+#include <stdint.h>
+
+namespace text_parsing
+{
+    /**
+     * Parse a decimal number and move begin past its digits.
+     */
+    inline uint16_t parse_uint16( const char *&begin, const char *end)
+    {
+        uint16_t result = 0;
+        while (begin != end and *begin >= '0' and *begin <= '9')
+        {
+            result = result * 10 + (*begin++ - '0');
+        }
+        return result;
+    }
+
+    /**
+     * If the text starts with the expectation, move begin past it and
+     * return true. Otherwise leave begin unchanged and return false.
+     */
+    inline bool consume( const char *&begin, const char *end, const char *expectation)
+    {
+        const char *current = begin;
+        while (*expectation)
+        {
+            if (current == end or *current != *expectation) return false;
+            ++current;
+            ++expectation;
+        }
+        begin = current;
+        return true;
+    }
+}
+
+#endif /* HOST_SIMPLE_TEXT_PARSING_H_ */
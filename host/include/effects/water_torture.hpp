@@ -0,0 +1,30 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in for the water torture effect of the ws2811 library. The
+// droplets are part of that library and are not simulated: they never
+// become active and draw nothing.
+//
+#ifndef HOST_WATER_TORTURE_HPP_
+#define HOST_WATER_TORTURE_HPP_
+
+namespace water_torture
+{
+    template< typename buffer_type, bool with_floor>
+    struct droplet
+    {
+        bool is_active() const { return false; }
+        void step( buffer_type &) {}
+    };
+
+    template< typename droplet_type>
+    void create_random_droplet( droplet_type &)
+    {
+    }
+}
+
+#endif /* HOST_WATER_TORTURE_HPP_ */
@@ -0,0 +1,92 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef HOST_BOARD_HPP_
+#define HOST_BOARD_HPP_
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * The simulated board that the host stand-ins of the avr headers and of the
+ * avr_utilities and ws2811 libraries talk to.
+ *
+ * Time only moves when advance_ticks() is called, for instance by a poll
+ * observer. The esp-link stand-in polls the board once for every pass of the
+ * main loop.
+ */
+namespace host
+{
+    /// Advance timer 1 and run its overflow interrupt when it wraps.
+    void advance_ticks( uint16_t ticks);
+
+    /// Ticks since the start of the program.
+    uint32_t ticks();
+
+    /// Called by pin stand-ins whenever a pin is written.
+    void write_pin( char port, uint8_t bit, bool value);
+    bool read_pin( char port, uint8_t bit);
+
+    /// Observe pin changes, e.g. to follow the chip select of the display.
+    using pin_observer = std::function<void ( char port, uint8_t bit, bool value)>;
+    void observe_pins( pin_observer observer);
+
+    /// Observe every byte that is shifted out by a bit-banged or hardware spi.
+    using spi_observer = std::function<void ( uint8_t byte)>;
+    void observe_spi( spi_observer observer);
+    void spi_byte( uint8_t byte);
+
+    /// Interrupt flag, as set by cli() and sei().
+    bool interrupts_enabled();
+    void set_interrupts( bool enabled);
+
+    using interrupt_observer = std::function<void ( bool enabled)>;
+    void observe_interrupts( interrupt_observer observer);
+
+    /**
+     * One call of ws2811::send(): the bytes on the wire, the pin and whether
+     * interrupts were enabled during the call.
+     */
+    struct strip_write
+    {
+        uint32_t             tick;
+        uint8_t              pin;
+        bool                 interrupts_enabled;
+        std::vector<uint8_t> bytes;
+    };
+    using strip_observer = std::function<void ( const strip_write &)>;
+    void observe_strip( strip_observer observer);
+    void strip_send( const void *bytes, uint16_t size, uint8_t pin);
+
+    /**
+     * The mqtt broker. Messages that the device publishes on topics that it
+     * has subscribed to are delivered back to it, as a real broker would.
+     */
+    void mqtt_setup();
+    void mqtt_subscribe( const std::string &topic);
+    void mqtt_publish( const std::string &topic, const std::string &message);
+    void mqtt_deliver( const std::string &topic, const std::string &message);
+
+    /// Poll the board and take the next message for the device, if any.
+    bool mqtt_receive( std::string &topic, std::string &message);
+
+    using poll_observer = std::function<void ()>;
+    void observe_poll( poll_observer observer);
+
+    using publish_observer = std::function<void ( const std::string &topic, const std::string &message)>;
+    void observe_publish( publish_observer observer);
+
+    /// True once the device has called the esp-link setup.
+    bool mqtt_is_setup();
+
+    /// Forget all observers, subscriptions and pending messages.
+    void reset();
+}
+
+#endif /* HOST_BOARD_HPP_ */
@@ -0,0 +1,38 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef HOST_CHECK_HPP_
+#define HOST_CHECK_HPP_
+#include <stdio.h>
+
+/**
+ * Minimal checks for the host tests: a failing CHECK prints its location
+ * and the test program returns the number of failures from CHECK_RESULT().
+ */
+namespace host
+{
+    inline int &check_failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline bool check( bool condition, const char *text, const char *file, int line)
+    {
+        if (not condition)
+        {
+            fprintf( stderr, "%s:%d: check failed: %s\n", file, line, text);
+            ++check_failures();
+        }
+        return condition;
+    }
+}
+
+#define CHECK( condition) host::check( (condition), #condition, __FILE__, __LINE__)
+#define CHECK_RESULT() (host::check_failures() ? 1 : 0)
+
+#endif /* HOST_CHECK_HPP_ */
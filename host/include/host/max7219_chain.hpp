@@ -0,0 +1,116 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef HOST_MAX7219_CHAIN_HPP_
+#define HOST_MAX7219_CHAIN_HPP_
+#include <stdint.h>
+#include <vector>
+
+namespace host
+{
+    /**
+     * Model of a daisy chain of max7219 chips, after the datasheet.
+     *
+     * Every chip has a 16-bit shift register. Data is shifted in most significant
+     * bit first and the bit that is shifted out of a chip 16 clocks later is
+     * shifted into the next chip of the chain. On the rising edge of LOAD (the
+     * chip select) every chip latches the word in its shift register: the low
+     * nibble of the high byte is the register address and the low byte is the data.
+     * Address 0 is the no-op register.
+     *
+     * The chip that is connected to the controller is chip 0. The model does
+     * not know how the digits of a chip are wired to its matrix.
+     */
+    class max7219_chain
+    {
+    public:
+        enum Register : uint8_t
+        {
+            NoOp        = 0x00,
+            Digit0      = 0x01,
+            DecodeMode  = 0x09,
+            Intensity   = 0x0a,
+            ScanLimit   = 0x0b,
+            Shutdown    = 0x0c,
+            DisplayTest = 0x0f
+        };
+
+        explicit max7219_chain( uint8_t chip_count)
+        :shift_registers( chip_count), registers( chip_count, std::vector<uint8_t>( 16))
+        {}
+
+        void shift( uint8_t byte)
+        {
+            uint8_t carry = byte;
+            for (auto &shift_register : shift_registers)
+            {
+                const uint8_t out = shift_register >> 8;
+                shift_register = static_cast<uint16_t>( (shift_register << 8) | carry);
+                carry = out;
+            }
+        }
+
+        void load()
+        {
+            for (uint8_t chip = 0; chip < shift_registers.size(); ++chip)
+            {
+                const uint8_t address = (shift_registers[chip] >> 8) & 0x0f;
+                if (address != NoOp)
+                {
+                    registers[chip][address] = shift_registers[chip] & 0xff;
+                    ++writes;
+                }
+            }
+        }
+
+        uint8_t get( uint8_t chip, uint8_t address) const
+        {
+            return registers[chip][address];
+        }
+
+        /// The digit registers of all chips, eight per chip, starting at chip 0.
+        std::vector<uint8_t> columns() const
+        {
+            std::vector<uint8_t> result;
+            for (const auto &chip : registers)
+            {
+                result.insert( result.end(), chip.begin() + Digit0, chip.begin() + Digit0 + 8);
+            }
+            return result;
+        }
+
+        /**
+         * What the chips drive: the digits, unless a chip is shut down, in
+         * display test mode or limited to fewer digits.
+         */
+        std::vector<uint8_t> image() const
+        {
+            std::vector<uint8_t> result;
+            for (const auto &chip : registers)
+            {
+                for (uint8_t digit = 0; digit < 8; ++digit)
+                {
+                    uint8_t column = chip[Digit0 + digit];
+                    if (chip[DisplayTest] & 1)          column = 0xff;
+                    else if (not (chip[Shutdown] & 1))  column = 0;
+                    else if (digit > (chip[ScanLimit] & 7)) column = 0;
+                    result.push_back( column);
+                }
+            }
+            return result;
+        }
+
+        /// The number of register writes, not counting no-ops.
+        uint32_t writes = 0;
+
+    private:
+        std::vector<uint16_t>             shift_registers;
+        std::vector<std::vector<uint8_t>> registers;
+    };
+}
+
+#endif /* HOST_MAX7219_CHAIN_HPP_ */
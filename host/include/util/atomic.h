@@ -0,0 +1,16 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in: the simulation has no concurrent interrupts.
+//
+#ifndef HOST_UTIL_ATOMIC_H_
+#define HOST_UTIL_ATOMIC_H_
+
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_BLOCK( type) for (bool host_atomic_once = true; host_atomic_once; host_atomic_once = false)
+
+#endif /* HOST_UTIL_ATOMIC_H_ */
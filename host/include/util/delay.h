@@ -0,0 +1,16 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in: busy waits take no time.
+//
+#ifndef HOST_UTIL_DELAY_H_
+#define HOST_UTIL_DELAY_H_
+
+inline void _delay_ms( double) {}
+inline void _delay_us( double) {}
+
+#endif /* HOST_UTIL_DELAY_H_ */
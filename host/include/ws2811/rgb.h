@@ -0,0 +1,46 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in for the rgb type of the ws2811 library. Colors are stored in
+// the order in which ws2811 leds expect them on the wire: green, red, blue.
+//
+#ifndef HOST_WS2811_RGB_H_
+#define HOST_WS2811_RGB_H_
+#include <stdint.h>
+#include <stddef.h>
+
+namespace ws2811
+{
+    struct rgb
+    {
+        rgb( uint8_t red = 0, uint8_t green = 0, uint8_t blue = 0)
+        :green{green}, red{red}, blue{blue}
+        {}
+
+        uint8_t green;
+        uint8_t red;
+        uint8_t blue;
+    };
+
+    inline bool operator==( const rgb &left, const rgb &right)
+    {
+        return left.red == right.red and left.green == right.green and left.blue == right.blue;
+    }
+
+    inline bool operator!=( const rgb &left, const rgb &right)
+    {
+        return not (left == right);
+    }
+
+    template< size_t size>
+    void clear( rgb (&leds)[size])
+    {
+        for (auto &led : leds) led = rgb{};
+    }
+}
+
+#endif /* HOST_WS2811_RGB_H_ */
@@ -0,0 +1,33 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in for the color operators of the ws2811 library.
+//
+#ifndef HOST_WS2811_RGB_OPERATORS_HPP_
+#define HOST_WS2811_RGB_OPERATORS_HPP_
+#include "rgb.h"
+
+namespace ws2811
+{
+    /**
+     * Blend from one color to another: a scale of 0 gives 'from'
+     * and a scale of 255 gives 'to'.
+     */
+    inline rgb fade( uint8_t scale, const rgb &from, const rgb &to)
+    {
+        auto blend = []( uint8_t a, uint8_t b, uint8_t scale) -> uint8_t
+            {
+                return a + ((b - a) * scale) / 255;
+            };
+        return rgb{
+            blend( from.red, to.red, scale),
+            blend( from.green, to.green, scale),
+            blend( from.blue, to.blue, scale)};
+    }
+}
+
+#endif /* HOST_WS2811_RGB_OPERATORS_HPP_ */
@@ -0,0 +1,31 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+// Host stand-in for the ws2811 send functions. The bytes that would go out on
+// the data pin are passed to the strip observers of the simulated board.
+//
+#ifndef HOST_WS2811_H_
+#define HOST_WS2811_H_
+#include "rgb.h"
+#include <avr/interrupt.h>
+#include <host/board.hpp>
+
+namespace ws2811
+{
+    inline void send( const void *values, uint16_t size, uint8_t bit)
+    {
+        host::strip_send( values, size, bit);
+    }
+
+    template< size_t size>
+    void send( const rgb (&leds)[size], uint8_t bit)
+    {
+        send( leds, size * sizeof leds[0], bit);
+    }
+}
+
+#endif /* HOST_WS2811_H_ */
@@ -0,0 +1,307 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+
+/**
+ * Host simulation of the firmware.
+ *
+ * Runs the main loop of wifimatrix.cpp against the stand-ins in include/ and
+ * feeds it the mqtt messages of a script. Every matrix frame, led frame and
+ * publication of the device is written to a log:
+ *
+ *     M <tick> <hex columns>       the image of the display after a complete frame
+ *     L <tick> <hex bytes>         the bytes sent to the led strip, in wire order
+ *     P <tick> <topic> <message>   a message that the device published
+ *
+ * The simulated clock only advances in the main loop, by one tick per pass, so
+ * ticks count from the moment the device connected, at 7812 ticks per second.
+ *
+ * A script has one message per line: the time in milliseconds after the device
+ * connected, the topic and the message, which may contain the escapes \\, \n and
+ * \xNN. A line with the topic "end" stops the simulation. Empty lines and lines
+ * that start with '#' are ignored.
+ *
+ * Usage: simulate <script> [<image directory>]
+ *
+ * With an image directory, every matrix frame is also written as a pbm and every
+ * led frame as a ppm image.
+ */
+
+#include <host/board.hpp>
+#include <host/max7219_chain.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * Everything that is sent to the display: spi bytes and the pins that
+     * go high, one of which is the chip select. This must be defined before the
+     * firmware, because the display is initialized during static initialization.
+     */
+    struct display_bus
+    {
+        struct event
+        {
+            char    port;   // zero for an spi byte
+            uint8_t value;  // the byte or the bit number of the pin
+        };
+
+        display_bus()
+        {
+            host::observe_spi( [this]( uint8_t byte){ events.push_back( { 0, byte});});
+            host::observe_pins( [this]( char port, uint8_t bit, bool value)
+                {
+                    if (value) events.push_back( { port, bit});
+                });
+        }
+
+        template< typename csk_type>
+        void replay( host::max7219_chain &chain)
+        {
+            for (const auto &e : events)
+            {
+                if (not e.port) chain.shift( e.value);
+                else if (e.port == csk_type::port and e.value == csk_type::bit) chain.load();
+            }
+            events.clear();
+        }
+
+        std::vector<event> events;
+    } bus;
+}
+
+#define main wifimatrix_main
+#include "../wifimatrix.cpp"
+#undef main
+
+namespace
+{
+    struct end_of_script {};
+
+    struct scripted_message
+    {
+        uint32_t    tick;
+        std::string topic;
+        std::string message;
+    };
+
+    std::string unescape( const std::string &text)
+    {
+        std::string result;
+        for (size_t index = 0; index < text.size(); ++index)
+        {
+            if (text[index] != '\\' or index + 1 == text.size())
+            {
+                result += text[index];
+                continue;
+            }
+
+            const char escaped = text[++index];
+            if (escaped == 'n')
+            {
+                result += '\n';
+            }
+            else if (escaped == 'x' and index + 2 < text.size())
+            {
+                result += static_cast<char>( std::stoi( text.substr( index + 1, 2), nullptr, 16));
+                index += 2;
+            }
+            else
+            {
+                result += escaped;
+            }
+        }
+        return result;
+    }
+
+    std::string escape( const std::string &text)
+    {
+        std::string result;
+        for (const char c : text)
+        {
+            if (c == '\\')
+            {
+                result += "\\\\";
+            }
+            else if (c < ' ' or c > '~')
+            {
+                char buffer[5];
+                snprintf( buffer, sizeof buffer, "\\x%02x", static_cast<uint8_t>( c));
+                result += buffer;
+            }
+            else
+            {
+                result += c;
+            }
+        }
+        return result;
+    }
+
+    std::vector<scripted_message> read_script( std::istream &input)
+    {
+        std::vector<scripted_message> script;
+        std::string line;
+        while (std::getline( input, line))
+        {
+            if (line.empty() or line[0] == '#') continue;
+
+            std::istringstream fields{ line};
+            uint32_t milliseconds = 0;
+            scripted_message message;
+            fields >> milliseconds >> message.topic;
+            std::getline( fields >> std::ws, message.message);
+            message.tick = milliseconds * uint32_t{ Timer::ticksPerSecond} / 1000;
+            message.message = unescape( message.message);
+            script.push_back( message);
+        }
+        return script;
+    }
+
+    std::string hex( const std::vector<uint8_t> &bytes)
+    {
+        std::string result;
+        for (const auto byte : bytes)
+        {
+            char buffer[3];
+            snprintf( buffer, sizeof buffer, "%02x", byte);
+            result += buffer;
+        }
+        return result;
+    }
+
+    class recorder
+    {
+    public:
+        recorder( std::ostream &log, const std::string &image_directory)
+        :log( log), image_directory( image_directory)
+        {}
+
+        void matrix_frame( uint32_t tick, const std::vector<uint8_t> &columns)
+        {
+            log << "M " << tick << ' ' << hex( columns) << '\n';
+            if (image_directory.empty()) return;
+
+            std::ofstream image{ image_name( "matrix", tick, ".pbm")};
+            image << "P1\n" << columns.size() << " 8\n";
+            for (uint8_t row = 0; row < 8; ++row)
+            {
+                for (const auto column : columns)
+                {
+                    image << ((column >> row) & 1) << ' ';
+                }
+                image << '\n';
+            }
+        }
+
+        void led_frame( uint32_t tick, const std::vector<uint8_t> &bytes)
+        {
+            log << "L " << tick << ' ' << hex( bytes) << '\n';
+            if (image_directory.empty()) return;
+
+            // the strip receives green, red, blue.
+            std::ofstream image{ image_name( "leds", tick, ".ppm")};
+            image << "P3\n" << bytes.size() / 3 << " 1\n255\n";
+            for (size_t led = 0; led + 2 < bytes.size(); led += 3)
+            {
+                image << int( bytes[led + 1]) << ' ' << int( bytes[led]) << ' ' << int( bytes[led + 2]) << '\n';
+            }
+        }
+
+        void publication( uint32_t tick, const std::string &topic, const std::string &message)
+        {
+            log << "P " << tick << ' ' << topic << ' ' << escape( message) << '\n';
+        }
+
+    private:
+        std::string image_name( const char *kind, uint32_t tick, const char *extension)
+        {
+            char buffer[32];
+            snprintf( buffer, sizeof buffer, "/%s-%08u", kind, static_cast<unsigned>( tick));
+            return image_directory + buffer + extension;
+        }
+
+        std::ostream &log;
+        std::string  image_directory;
+    };
+}
+
+int main( int argc, char *argv[])
+{
+    if (argc < 2 or argc > 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <script> [<image directory>]\n";
+        return 2;
+    }
+
+    std::ifstream script_file{ argv[1]};
+    if (not script_file)
+    {
+        std::cerr << "can't open " << argv[1] << '\n';
+        return 2;
+    }
+    const auto script = read_script( script_file);
+    recorder output{ std::cout, argc == 3 ? argv[2] : ""};
+
+    host::max7219_chain chain{ matrix_count};
+
+    std::vector<uint8_t> strip;
+    host::observe_strip( [&]( const host::strip_write &write)
+        {
+            if (host::mqtt_is_setup()) strip.insert( strip.end(), write.bytes.begin(), write.bytes.end());
+        });
+
+    host::observe_publish( [&]( const std::string &topic, const std::string &message)
+        {
+            output.publication( host::ticks(), topic, message);
+        });
+
+    // every pass of the main loop takes one tick. The frames and the led strip
+    // are logged at the end of a pass, once they have been sent completely.
+    // The display uses column_wiring, so the digits of the chain are its columns.
+    bus.replay<csk_type>( chain);
+    std::vector<uint8_t> shown = chain.image();
+    auto next_message = script.begin();
+    host::observe_poll( [&]()
+        {
+            if (not strip.empty())
+            {
+                output.led_frame( host::ticks(), strip);
+                strip.clear();
+            }
+
+            bus.replay<csk_type>( chain);
+            const auto columns = chain.image();
+            if (display.transmit_done() and columns != shown)
+            {
+                output.matrix_frame( host::ticks(), columns);
+                shown = columns;
+            }
+
+            host::advance_ticks( 1);
+            while (next_message != script.end() and next_message->tick <= host::ticks())
+            {
+                if (next_message->topic == "end") throw end_of_script{};
+                host::mqtt_deliver( next_message->topic, next_message->message);
+                ++next_message;
+            }
+        });
+
+    try
+    {
+        wifimatrix_main();
+    }
+    catch (const end_of_script &)
+    {
+    }
+
+    return 0;
+}
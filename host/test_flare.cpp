@@ -0,0 +1,92 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "../flare.hpp"
+#include <initializer_list>
+#include <host/check.hpp>
+
+namespace
+{
+    /**
+     * The flare as it used to be: stepping one scale step at a time.
+     */
+    struct reference_flare
+    {
+        flare::Mode mode;
+        uint8_t     scale;
+        uint16_t    accumulator;
+        uint8_t     speed;
+
+        void step()
+        {
+            accumulator += speed;
+            while (accumulator >= 16)
+            {
+                accumulator -= 16;
+                if (mode == flare::BackAndForthForward)
+                {
+                    if (++scale == 255) mode = flare::BackAndForthBackward;
+                }
+                else if (mode == flare::OneShot)
+                {
+                    if (scale != 255) ++scale;
+                    else mode = flare::Off;
+                }
+                else if (mode == flare::BackAndForthBackward)
+                {
+                    if (--scale == 0) mode = flare::BackAndForthForward;
+                }
+            }
+        }
+    };
+
+    const ws2811::rgb black{ 0, 0, 0};
+    const ws2811::rgb white{ 255, 255, 255};
+
+    /// With a linear curve from black to white, the red channel of the led is the scale.
+    bool same( const flare &f, const reference_flare &reference)
+    {
+        ws2811::rgb leds[1];
+        const bool active = f.render( leds);
+        if (active != (reference.mode != flare::Off)) return false;
+        return not active or leds[0].red == reference.scale;
+    }
+}
+
+int main()
+{
+    // every speed in both modes that start at scale zero, for longer
+    // than a complete period.
+    for (const auto mode : { flare::OneShot, flare::BackAndForthForward})
+    {
+        for (uint16_t speed = 0; speed < 256; ++speed)
+        {
+            flare f;
+            f.setup( 0, mode, black, white, speed);
+            reference_flare reference{ mode, 0, 0, static_cast<uint8_t>( speed)};
+
+            bool equal = true;
+            for (uint16_t frame = 0; frame < 600 and equal; ++frame)
+            {
+                f.step();
+                reference.step();
+                equal = same( f, reference);
+            }
+            CHECK( equal);
+        }
+    }
+
+    // the old flare got stuck when it started backward at scale zero.
+    // Now it bounces and continues forward.
+    flare f;
+    f.setup( 0, flare::BackAndForthBackward, black, white, 32);
+    f.step();
+    ws2811::rgb leds[1];
+    CHECK( f.render( leds) and leds[0].red == 2);
+
+    return CHECK_RESULT();
+}
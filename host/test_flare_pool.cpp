@@ -0,0 +1,152 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "../flare_pool.hpp"
+#include "../simple_random.hpp"
+#include <host/check.hpp>
+
+namespace
+{
+    constexpr uint8_t flare_count = 20;
+    constexpr uint8_t led_count = 60;
+    using pool_type = flare_pool<flare_count, led_count>;
+
+    /**
+     * What the pool should do, kept in the simplest possible way: an array
+     * of flares, each remembering whether it is active.
+     */
+    struct reference_pool
+    {
+        flare flares[flare_count];
+
+        uint8_t flare_of_led( uint8_t led) const
+        {
+            for (uint8_t index = 0; index < flare_count; ++index)
+            {
+                if (flares[index].is_active() and flares[index].led_index() == led) return index;
+            }
+            return pool_type::none;
+        }
+
+        uint8_t active_count() const
+        {
+            uint8_t count = 0;
+            for (const auto &f : flares) count += f.is_active();
+            return count;
+        }
+
+        void start( uint8_t index, uint8_t led, flare::Mode mode, uint8_t speed)
+        {
+            const auto previous = flare_of_led( led);
+            if (previous != pool_type::none) flares[previous].stop();
+            if (mode == flare::Off)
+            {
+                flares[index].stop();
+            }
+            else
+            {
+                flares[index].setup( led, mode, ws2811::rgb{ 0, 0, 0}, ws2811::rgb{ 255, 255, 255}, speed);
+            }
+        }
+
+        void update( ws2811::rgb (&leds)[led_count])
+        {
+            for (auto &f : flares)
+            {
+                if (not f.is_active()) continue;
+                f.step();
+                f.render( leds);
+            }
+        }
+    };
+
+    bool same_leds( const ws2811::rgb (&left)[led_count], const ws2811::rgb (&right)[led_count])
+    {
+        for (uint8_t led = 0; led < led_count; ++led)
+        {
+            if (left[led] != right[led]) return false;
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    pool_type pool;
+    reference_pool reference;
+    ws2811::rgb leds[led_count];
+    ws2811::rgb expected[led_count];
+
+    seed_random( 1);
+    for (uint32_t round = 0; round < 100000; ++round)
+    {
+        const uint8_t led = no_more_than( led_count);
+        const auto mode = static_cast<flare::Mode>( no_more_than( flare::ModeCount));
+        const uint8_t speed = my_rand();
+
+        switch (no_more_than( 8))
+        {
+        case 0:
+        {
+            // start a given flare, which may take it away from another led.
+            const uint8_t index = no_more_than( flare_count);
+            pool.start( index, led, mode, ws2811::rgb{ 0, 0, 0}, ws2811::rgb{ 255, 255, 255}, speed, easing::Linear);
+            reference.start( index, led, mode, speed);
+            break;
+        }
+
+        case 1:
+        case 2:
+        case 3:
+        {
+            // start the flare that find() returns, the way "flare/*" does.
+            const auto index = pool.find( led);
+            const auto animating = reference.flare_of_led( led);
+            if (animating != pool_type::none)
+            {
+                CHECK( index == animating);
+            }
+            else if (reference.active_count() == flare_count)
+            {
+                CHECK( index == pool_type::none);
+            }
+            else
+            {
+                CHECK( index != pool_type::none and not reference.flares[index].is_active());
+            }
+
+            if (index != pool_type::none)
+            {
+                pool.start( index, led, mode, ws2811::rgb{ 0, 0, 0}, ws2811::rgb{ 255, 255, 255}, speed, easing::Linear);
+                reference.start( index, led, mode, speed);
+            }
+            break;
+        }
+
+        case 4:
+            if (no_more_than( 64) == 0)
+            {
+                pool.stop_all();
+                for (auto &f : reference.flares) f.stop();
+            }
+            break;
+
+        default:
+        {
+            const bool changed = pool.update( leds);
+            reference.update( expected);
+            CHECK( changed == (reference.active_count() != 0));
+            CHECK( same_leds( leds, expected));
+            break;
+        }
+        }
+
+        if (host::check_failures()) break;
+    }
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,32 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <stdint.h>
+#include "../glyph_index.hpp"
+#include <host/check.hpp>
+
+int main()
+{
+    glyph_index glyphs;
+    glyphs.build();
+    CHECK( glyphs.is_direct());
+
+    for (int character = 1; character < 256; ++character)
+    {
+        const char c = character;
+        CHECK( glyphs.find( c) == font5x8::find_character( c));
+
+        uint8_t columns = 1;
+        for (auto column = font5x8::find_character( c); column and pgm_read_byte( column); ++column)
+        {
+            ++columns;
+        }
+        CHECK( glyphs.columns( c) == (c == ' ' ? 2 : columns));
+    }
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,123 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "../led_timeline.hpp"
+#include <ws2811/rgb_operators.hpp>
+#include <host/check.hpp>
+#include <math.h>
+
+namespace
+{
+    constexpr uint8_t led_count = 10;
+
+    led_keyframe keyframe( uint8_t first, uint8_t last, const ws2811::rgb &to, uint16_t duration, bool with_previous = false)
+    {
+        led_keyframe key;
+        key.first = first;
+        key.last = last;
+        key.to = to;
+        key.duration = duration;
+        key.curve = easing::Linear;
+        key.with_previous = with_previous;
+        return key;
+    }
+
+    bool all( const ws2811::rgb (&leds)[led_count], uint8_t first, uint8_t last, const ws2811::rgb &color)
+    {
+        for (uint8_t led = first; led <= last; ++led)
+        {
+            if (leds[led] != color) return false;
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    const ws2811::rgb black{ 0, 0, 0};
+    const ws2811::rgb red{ 255, 0, 0};
+    const ws2811::rgb blue{ 0, 0, 255};
+
+    led_timeline<4> timeline;
+    ws2811::rgb leds[led_count];
+
+    // nothing happens without keyframes.
+    timeline.start( false);
+    CHECK( not timeline.step( leds));
+
+    // a keyframe fades its range in 'duration' frames and leaves the other leds alone.
+    CHECK( timeline.add( keyframe( 2, 5, red, 4)));
+    timeline.start( false);
+    CHECK( timeline.step( leds));
+    CHECK( all( leds, 2, 5, ws2811::fade( 255 / 4, black, red)));
+    CHECK( all( leds, 0, 1, black) and all( leds, 6, 9, black));
+    timeline.step( leds);
+    timeline.step( leds);
+    timeline.step( leds);
+    CHECK( all( leds, 2, 5, red));
+    CHECK( not timeline.step( leds));
+
+    // keyframes marked with_previous play together, and the group takes as
+    // long as its longest keyframe.
+    ws2811::clear( leds);
+    timeline.clear();
+    CHECK( timeline.add( keyframe( 0, 1, red, 2)));
+    CHECK( timeline.add( keyframe( 8, 9, blue, 6, true)));
+    CHECK( timeline.add( keyframe( 0, 9, black, 1)));
+    CHECK( timeline.add( keyframe( 4, 4, blue, 1)));
+    CHECK( not timeline.add( keyframe( 4, 4, blue, 1)));
+    timeline.start( false);
+    timeline.step( leds);
+    timeline.step( leds);
+    CHECK( all( leds, 0, 1, red));
+    CHECK( not all( leds, 8, 9, blue) and leds[8].blue != 0);
+    for (int frame = 0; frame < 4; ++frame) timeline.step( leds);
+    CHECK( all( leds, 0, 1, red) and all( leds, 8, 9, blue));
+
+    // the next group fades from the color of its first led.
+    timeline.step( leds);
+    CHECK( all( leds, 0, 9, black));
+    timeline.step( leds);
+    CHECK( leds[4] == blue);
+    CHECK( not timeline.step( leds));
+
+    // without a stored start color, every curve still follows the fade from
+    // the start color. Each frame rounds the color of the first led, which
+    // can add up to a few steps, but a keyframe ends exactly at its target.
+    for (uint8_t curve = 0; curve < easing::CurveCount; ++curve)
+    {
+        const ws2811::rgb from{ 10, 200, 30};
+        const ws2811::rgb to{ 250, 0, 90};
+        const uint16_t duration = 37;
+        for (auto &led : leds) led = from;
+        timeline.clear();
+        auto key = keyframe( 0, 9, to, duration);
+        key.curve = curve;
+        CHECK( timeline.add( key));
+        timeline.start( false);
+        for (uint16_t frame = 1; frame <= duration; ++frame)
+        {
+            timeline.step( leds);
+            const auto progress = easing::apply( static_cast<easing::Curve>( curve), frame * 255ul / duration);
+            CHECK( abs( leds[0].red   - (from.red   + (to.red   - from.red)   * progress / 255.0)) <= 4);
+            CHECK( abs( leds[0].green - (from.green + (to.green - from.green) * progress / 255.0)) <= 4);
+            CHECK( abs( leds[0].blue  - (from.blue  + (to.blue  - from.blue)  * progress / 255.0)) <= 4);
+        }
+        CHECK( all( leds, 0, 9, to));
+    }
+
+    // a looping timeline restarts until it is stopped.
+    timeline.start( true);
+    for (int frame = 0; frame < 100; ++frame)
+    {
+        CHECK( timeline.step( leds));
+    }
+    timeline.stop();
+    CHECK( not timeline.step( leds));
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,371 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+
+/**
+ * Checks the byte stream that matrix_display sends against a datasheet model
+ * of a max7219 chain, for the bit-banged spi, the hardware spi and the
+ * parallel spi, and for matrices with their digits wired as columns or as rows.
+ */
+#include <avr_utilities/pin_definitions.hpp>
+#include <avr_utilities/devices/bitbanged_spi.h>
+#include "../matrix_display.hpp"
+#include "../hardware_spi.hpp"
+#include "../parallel_spi.hpp"
+#include "../simple_random.hpp"
+#include <host/board.hpp>
+#include <host/max7219_chain.hpp>
+#include <host/check.hpp>
+
+#include <initializer_list>
+#include <vector>
+
+namespace
+{
+    constexpr uint8_t matrix_count = 9;
+
+    struct spi_pins
+    {
+        PIN_TYPE( B, 3) mosi;
+        PIN_TYPE( B, 5) clk;
+        pin_definitions::null_pin_type miso;
+    };
+
+    /// A byte on the bus, or a rising edge of the chip select (-1).
+    using bus_log = std::vector<int16_t>;
+
+    /**
+     * Records the bus of a display from the moment it is created.
+     */
+    template< char cs_port, uint8_t cs_bit>
+    struct bus_recorder
+    {
+        bus_recorder()
+        {
+            host::reset();
+            host::observe_spi( [this]( uint8_t byte){ log.push_back( byte);});
+            host::observe_pins( [this]( char port, uint8_t bit, bool value)
+                {
+                    if (port == cs_port and bit == cs_bit and value) log.push_back( -1);
+                });
+        }
+
+        /// Feed everything since the last call to the chain.
+        void replay( host::max7219_chain &chain)
+        {
+            for (; replayed < log.size(); ++replayed)
+            {
+                if (log[replayed] < 0) chain.load();
+                else chain.shift( log[replayed]);
+            }
+        }
+
+        bus_log log;
+        size_t  replayed = 0;
+    };
+
+    /// The columns that a chain shows if digit n of a chip drives column n.
+    std::vector<uint8_t> shown( const host::max7219_chain &chain, column_wiring)
+    {
+        return chain.columns();
+    }
+
+    /**
+     * The columns that a chain shows if digit n of a chip drives row n, with
+     * the leftmost column in the most significant bit.
+     */
+    std::vector<uint8_t> shown( const host::max7219_chain &chain, row_wiring)
+    {
+        const auto rows = chain.columns();
+        std::vector<uint8_t> result( rows.size());
+        for (size_t matrix = 0; matrix < rows.size(); matrix += 8)
+        {
+            for (uint8_t row = 0; row < 8; ++row)
+            {
+                for (uint8_t column = 0; column < 8; ++column)
+                {
+                    if (rows[matrix + row] & (0x80 >> column)) result[matrix + column] |= 1 << row;
+                }
+            }
+        }
+        return result;
+    }
+
+    /// The number of digit registers that differ between two states of a chain.
+    uint16_t differences( const std::vector<uint8_t> &before, const std::vector<uint8_t> &after)
+    {
+        uint16_t count = 0;
+        for (size_t digit = 0; digit < before.size(); ++digit)
+        {
+            if (before[digit] != after[digit]) ++count;
+        }
+        return count;
+    }
+
+    /**
+     * Draw a number of frames, each of which changes a random amount of
+     * columns, and check that the chain shows each of them. Returns the bus log.
+     */
+    template< typename spi_type, typename csk_type, typename wiring = column_wiring>
+    bus_log check_frames()
+    {
+        bus_recorder< csk_type::port, csk_type::bit> bus;
+        matrix_display< matrix_count, spi_type, csk_type, wiring> display;
+        host::max7219_chain chain{ matrix_count};
+
+        // every register is initialized.
+        bus.replay( chain);
+        for (uint8_t chip = 0; chip < matrix_count; ++chip)
+        {
+            CHECK( chain.get( chip, host::max7219_chain::DisplayTest) == 0);
+            CHECK( chain.get( chip, host::max7219_chain::ScanLimit) == 7);
+            CHECK( chain.get( chip, host::max7219_chain::DecodeMode) == 0);
+            CHECK( chain.get( chip, host::max7219_chain::Intensity) == display.default_intensity);
+            CHECK( chain.get( chip, host::max7219_chain::Shutdown) == 1);
+        }
+
+        seed_random( 1);
+        std::vector<uint8_t> columns( display.column_count);
+        for (uint16_t frame = 0; frame < 500; ++frame)
+        {
+            const uint16_t changes = no_more_than( frame % 10 ? 4 : display.column_count);
+            for (uint16_t change = 0; change < changes; ++change)
+            {
+                columns[no_more_than( display.column_count)] = my_rand();
+            }
+
+            display.clear();
+            for (const auto column : columns) display.push_column( column);
+
+            const auto writes = chain.writes;
+            const auto before = chain.columns();
+            display.transmit();
+            bus.replay( chain);
+            CHECK( shown( chain, wiring{}) == columns);
+
+            // only digits that changed are written.
+            CHECK( chain.writes - writes == differences( before, chain.columns()));
+        }
+
+        // a frame that is sent in steps is completed when the next frame
+        // starts, before its buffer is cleared.
+        columns[0] ^= 0xff;
+        columns[display.column_count - 1] ^= 0xff;
+        display.clear();
+        for (const auto column : columns) display.push_column( column);
+        display.start_transmit();
+        display.transmit_step();
+        CHECK( not display.transmit_done());
+        display.clear();
+        CHECK( display.transmit_done());
+        bus.replay( chain);
+        CHECK( shown( chain, wiring{}) == columns);
+
+        display.brightness( 3);
+        display.enable( false);
+        bus.replay( chain);
+        for (uint8_t chip = 0; chip < matrix_count; ++chip)
+        {
+            CHECK( chain.get( chip, host::max7219_chain::Intensity) == 3);
+            CHECK( chain.get( chip, host::max7219_chain::Shutdown) == 0);
+        }
+
+        return bus.log;
+    }
+
+    /**
+     * Check the exact bytes for a frame in which one column changes, as
+     * the datasheet describes them.
+     */
+    void check_single_digit()
+    {
+        bus_recorder< 'B', 4> bus;
+        matrix_display< matrix_count, bitbanged_spi< spi_pins>, PIN_TYPE( B, 4)> display;
+        bus.log.clear();
+
+        // column 10 is digit 2 of the second matrix, which is the second chip
+        // from the controller. The word for the last chip is sent first.
+        display.clear();
+        display.set_pixel( 10, 0);
+        display.set_pixel( 10, 7);
+        display.transmit();
+
+        bus_log expected;
+        for (uint8_t chip = matrix_count; chip--;)
+        {
+            expected.push_back( chip == 1 ? 0x03 : 0x00);
+            expected.push_back( chip == 1 ? 0x81 : 0x00);
+        }
+        expected.push_back( -1);
+        CHECK( bus.log == expected);
+
+        // an unchanged frame is not sent at all.
+        bus.log.clear();
+        display.transmit();
+        CHECK( bus.log.empty());
+    }
+
+    /**
+     * The same frame on matrices that are wired by rows: column 10 is the
+     * third column of the second matrix, so digits 0 and 7 of the second chip
+     * get bit 5.
+     */
+    void check_single_digit_rows()
+    {
+        bus_recorder< 'B', 4> bus;
+        matrix_display< matrix_count, bitbanged_spi< spi_pins>, PIN_TYPE( B, 4), row_wiring> display;
+        bus.log.clear();
+
+        display.clear();
+        display.set_pixel( 10, 0);
+        display.set_pixel( 10, 7);
+        display.transmit();
+
+        bus_log expected;
+        for (const uint8_t digit : { 0, 7})
+        {
+            for (uint8_t chip = matrix_count; chip--;)
+            {
+                expected.push_back( chip == 1 ? 0x01 + digit : 0x00);
+                expected.push_back( chip == 1 ? 0x20 : 0x00);
+            }
+            expected.push_back( -1);
+        }
+        CHECK( bus.log == expected);
+    }
+}
+
+namespace
+{
+    /**
+     * Stand-in for PORTB that decodes the writes of a parallel_spi with its
+     * clock on bit 5 and its data on bits 3, 2 and 1 into a byte stream per chain.
+     * The chip select, on bit 4, is written as usual, through the pin stand-ins.
+     */
+    struct parallel_port
+    {
+        static constexpr uint8_t clk = 1 << 5;
+        static constexpr uint8_t data[] = { 1 << 3, 1 << 2, 1 << 1};
+        static constexpr uint8_t chain_count = sizeof data;
+
+        parallel_port &operator=( uint8_t new_value)
+        {
+            if ((new_value & clk) and not (value & clk))
+            {
+                for (uint8_t chain = 0; chain < chain_count; ++chain)
+                {
+                    shift[chain] = (shift[chain] << 1) | ((new_value & data[chain]) != 0);
+                }
+                if (++bits == 8)
+                {
+                    for (uint8_t chain = 0; chain < chain_count; ++chain)
+                    {
+                        logs[chain].push_back( shift[chain]);
+                    }
+                    bits = 0;
+                }
+            }
+            value = new_value;
+            return *this;
+        }
+
+        parallel_port &operator&=( uint8_t mask)
+        {
+            return *this = value & mask;
+        }
+
+        operator uint8_t() const
+        {
+            return value;
+        }
+
+        uint8_t  value = 0;
+        uint8_t  shift[chain_count] = {0};
+        uint8_t  bits = 0;
+        bus_log  logs[chain_count];
+    };
+
+    constexpr uint8_t parallel_port::data[];
+
+    struct port_b
+    {
+        static parallel_port &port()
+        {
+            static parallel_port p;
+            return p;
+        }
+
+        static volatile uint8_t &ddr()
+        {
+            return DDRB;
+        }
+    };
+
+    /**
+     * Drive three chains of three matrices with a parallel_spi and check that the
+     * first chain shows the leftmost matrices.
+     */
+    void check_parallel()
+    {
+        host::reset();
+        auto &port = port_b::port();
+        host::observe_pins( [&]( char p, uint8_t bit, bool value)
+            {
+                if (p == 'B' and bit == 4 and value)
+                {
+                    for (auto &log : port.logs) log.push_back( -1);
+                }
+            });
+
+        using spi_type = parallel_spi< port_b, 5, 3, 2, 1>;
+        matrix_display< matrix_count, spi_type, PIN_TYPE( B, 4)> display;
+        CHECK( port.bits == 0);
+
+        seed_random( 2);
+        std::vector<uint8_t> columns( display.column_count);
+        for (uint16_t frame = 0; frame < 100; ++frame)
+        {
+            for (uint8_t change = 0; change < 5; ++change)
+            {
+                columns[no_more_than( display.column_count)] = my_rand();
+            }
+            display.clear();
+            for (const auto column : columns) display.push_column( column);
+            display.transmit();
+
+            std::vector<uint8_t> shown;
+            for (const auto &log : port.logs)
+            {
+                host::max7219_chain chain{ matrix_count / parallel_port::chain_count};
+                for (const auto event : log)
+                {
+                    if (event < 0) chain.load();
+                    else chain.shift( event);
+                }
+                CHECK( chain.get( 0, host::max7219_chain::Shutdown) == 1);
+                const auto chain_columns = chain.columns();
+                shown.insert( shown.end(), chain_columns.begin(), chain_columns.end());
+            }
+            CHECK( shown == columns);
+        }
+    }
+}
+
+int main()
+{
+    check_single_digit();
+    check_single_digit_rows();
+
+    const auto bitbanged = check_frames< bitbanged_spi< spi_pins>, PIN_TYPE( B, 4)>();
+    const auto hardware = check_frames< hardware_spi, PIN_TYPE( B, 2)>();
+    CHECK( bitbanged == hardware);
+    check_frames< bitbanged_spi< spi_pins>, PIN_TYPE( B, 4), row_wiring>();
+
+    check_parallel();
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,136 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+
+/**
+ * Checks of the parsers for the payloads and topics of mqtt messages. After
+ * each parser, the rest of the string must start right after what was parsed,
+ * with a length that ends at the end of the original string.
+ *
+ * Also checks that the messages that the device publishes itself, and receives
+ * back from the broker, are not counted for acknowledgement, and that a
+ * deferred text holds back the display until it is shown.
+ */
+#define main wifimatrix_main
+#include "../wifimatrix.cpp"
+#undef main
+
+#include <host/check.hpp>
+#include <string.h>
+#include <initializer_list>
+#include <string>
+
+namespace
+{
+    esp_link::string_ref ref( const char *text)
+    {
+        esp_link::string_ref result;
+        result.buffer = text;
+        result.len = strlen( text);
+        return result;
+    }
+
+    /// The rest of the string must be exactly 'expected'.
+    bool rest_is( const esp_link::string_ref &string, const char *expected)
+    {
+        return string.len == strlen( expected)
+                and strncmp( string.buffer, expected, string.len) == 0;
+    }
+}
+
+int main()
+{
+    {
+        auto message = ref( "#00ff80,16");
+        CHECK( parse_rgb( message) == ws2811::rgb( 0, 255, 128));
+        CHECK( rest_is( message, ",16"));
+    }
+
+    {
+        auto message = ref( "1,2,3;4");
+        CHECK( parse_rgb( message) == ws2811::rgb( 1, 2, 3));
+        CHECK( rest_is( message, ";4"));
+    }
+
+    {
+        // missing digits count as zero.
+        auto message = ref( "#ff8");
+        CHECK( parse_rgb( message) == ws2811::rgb( 255, 8, 0));
+        CHECK( rest_is( message, ""));
+    }
+
+    {
+        // a flare with hexadecimal colors keeps its speed.
+        auto message = ref( "#102030,#405060,16");
+        CHECK( parse_rgb( message) == ws2811::rgb( 0x10, 0x20, 0x30));
+        CHECK( consume( message, ","));
+        CHECK( parse_rgb( message) == ws2811::rgb( 0x40, 0x50, 0x60));
+        CHECK( consume( message, ","));
+        CHECK( parse_uint16( message) == 16);
+        CHECK( rest_is( message, ""));
+    }
+
+    {
+        ws2811::rgb leds[3];
+        auto message = ref( "010203a0b0c0ffffffffffff");
+        set_leds_hex( leds, 1, message);
+        CHECK( leds[0] == ws2811::rgb( 0, 0, 0));
+        CHECK( leds[1] == ws2811::rgb( 1, 2, 3));
+        CHECK( leds[2] == ws2811::rgb( 0xa0, 0xb0, 0xc0));
+    }
+
+    {
+        auto topic = ref( "fireworks/rockets");
+        esp_link::string_ref word;
+        CHECK( consume_topic_word( topic, word) == topic_hash( "fireworks"));
+        CHECK( rest_is( word, "fireworks"));
+        CHECK( rest_is( topic, "rockets"));
+        CHECK( is_topic_word( word, PSTR( "fireworks")));
+        CHECK( not is_topic_word( word, PSTR( "fire")));
+        CHECK( not is_topic_word( word, PSTR( "fireworks2")));
+    }
+
+    {
+        // different words with the same hash.
+        auto topic = ref( "agzl");
+        esp_link::string_ref word;
+        CHECK( consume_topic_word( topic, word) == topic_hash( "flash"));
+        CHECK( not is_topic_word( word, PSTR( "flash")));
+    }
+
+    {
+        g.ack_interval = 1;
+        for (const char *topic : { "version", "ack", "stats"})
+        {
+            const esp_link::packet own{ std::string{ MQTT_BASE_NAME} + topic, "1"};
+            const auto sequence = g.sequence;
+            update( &own, 0);
+            CHECK( g.sequence == sequence);
+            CHECK( not g.ack_pending);
+        }
+
+        const esp_link::packet other{ MQTT_BASE_NAME "scrollSpeed", "10"};
+        const auto sequence = g.sequence;
+        update( &other, 0);
+        CHECK( g.sequence == sequence + 1);
+        CHECK( g.ack_pending);
+    }
+
+    {
+        // a text is not shown, and the display does not scroll, until its
+        // ShowText command has run.
+        const esp_link::packet text{ MQTT_BASE_NAME "text", "Hello"};
+        update( &text, 0);
+        CHECK( g.show_pending);
+        command c;
+        while (g.commands.pop( c)) execute( c);
+        CHECK( not g.show_pending);
+        CHECK( g.display_changed);
+    }
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,62 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <stdint.h>
+#include <initializer_list>
+#include "../simple_random.hpp"
+#include <host/check.hpp>
+
+int main()
+{
+    // the generator visits every non-zero state once per period.
+    seed_random( 1);
+    uint32_t period = 0;
+    bool zero = false;
+    do
+    {
+        zero = zero or not my_rand();
+        ++period;
+    }
+    while (random_state() != 1 and period <= 65536);
+    CHECK( period == 65535);
+    CHECK( not zero);
+
+    // zero is not a valid seed.
+    seed_random( 0);
+    CHECK( random_state() == 1);
+
+    // the same seed gives the same sequence.
+    seed_random( 4711);
+    const auto first = my_rand();
+    const auto second = my_rand();
+    seed_random( 4711);
+    CHECK( my_rand() == first);
+    CHECK( my_rand() == second);
+
+    // ranges are reduced without leaving them and reach both ends.
+    for (const uint16_t range : { 1, 2, 3, 7, 72, 100, 1000})
+    {
+        uint16_t lowest = 0xffff;
+        uint16_t highest = 0;
+        for (uint32_t count = 0; count < 65535; ++count)
+        {
+            const auto value = no_more_than( range);
+            if (value < lowest) lowest = value;
+            if (value > highest) highest = value;
+        }
+        CHECK( lowest == 0);
+        CHECK( highest == range - 1);
+    }
+
+    for (uint32_t count = 0; count < 65535; ++count)
+    {
+        const auto value = plusminus( 5);
+        CHECK( value >= -5 and value <= 5);
+    }
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,117 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+
+/**
+ * Model of the uart receiver while send_leds() sends the strip, to show that no
+ * received byte is lost at the configured baud rate.
+ *
+ * The esp sends bytes back to back, so a byte completes every byte time (10
+ * bits). As in the firmware, the receive register is taken to hold a single byte,
+ * which the uart interrupt handler reads as soon as interrupts are enabled. A byte
+ * is lost if the next one completes before that. The strip takes 1.25 us per
+ * bit with interrupts disabled during each call of send().
+ */
+#define main wifimatrix_main
+#include "../wifimatrix.cpp"
+#undef main
+
+#include <host/check.hpp>
+#include <vector>
+
+namespace
+{
+    /// A period with interrupts disabled, in microseconds.
+    struct window
+    {
+        double start;
+        double end;
+    };
+
+    constexpr double byte_time = 1e6 * 10 / uart_baud_rate;
+
+    /// Time between two sends, to enable interrupts and run the loop again.
+    constexpr double gap = 2;
+
+    /**
+     * Return whether a byte is lost for any phase of the received bytes
+     * relative to the windows.
+     */
+    bool loses_byte( const std::vector<window> &windows)
+    {
+        const double end = windows.back().end;
+        for (double phase = 0; phase < byte_time; phase += 0.5)
+        {
+            double read_time = phase - 2 * byte_time;
+            for (double completion = phase - byte_time; completion < end + byte_time; completion += byte_time)
+            {
+                if (completion < read_time) return true;
+
+                read_time = completion;
+                for (const auto &w : windows)
+                {
+                    if (completion >= w.start and completion < w.end) read_time = w.end;
+                }
+            }
+        }
+        return false;
+    }
+}
+
+int main()
+{
+    std::vector<window> windows;
+    bool enabled_between_sends = true;
+    bool disabled_during_sends = true;
+    bool sent = false;
+
+    host::observe_interrupts( [&]( bool enabled)
+        {
+            if (enabled) sent = false;
+        });
+
+    double time = 0;
+    host::observe_strip( [&]( const host::strip_write &write)
+        {
+            disabled_during_sends = disabled_during_sends and not write.interrupts_enabled;
+            enabled_between_sends = enabled_between_sends and not sent;
+            sent = true;
+
+            const double duration = write.bytes.size() * 8 * 1.25;
+            windows.push_back( { time, time + duration});
+            time += duration + gap;
+        });
+
+    host::set_interrupts( true);
+    send_leds();
+
+    CHECK( not windows.empty());
+    CHECK( disabled_during_sends);
+    CHECK( enabled_between_sends);
+    CHECK( host::interrupts_enabled());
+
+    uint16_t bytes = 0;
+    double longest = 0;
+    for (const auto &w : windows)
+    {
+        bytes += (w.end - w.start) / 8 / 1.25;
+        if (w.end - w.start > longest) longest = w.end - w.start;
+    }
+    CHECK( bytes == led_count * 3);
+
+    CHECK( not loses_byte( windows));
+
+    // the firmware keeps every window below half a byte time, to leave room for
+    // the handler itself and for other interrupts.
+    CHECK( longest < byte_time / 2);
+
+    // the model does notice windows that are too long.
+    CHECK( loses_byte( { { 0, 1.5 * byte_time}}));
+    CHECK( loses_byte( { { 0, byte_time * 0.9}, { byte_time * 0.9 + gap, byte_time * 1.8}}) == false);
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,167 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+
+/**
+ * Checks of the column cache and the text scroller. Every frame of a
+ * scrolling text must show the same window as a reference that walks the
+ * whole text, followed by repeat_space empty columns, over and over. This
+ * must hold for texts that fit in the cache and for texts that are scrolled
+ * from the string.
+ */
+#define main wifimatrix_main
+#include "../wifimatrix.cpp"
+#undef main
+
+#include <host/check.hpp>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /// Stand-in for the display that records the columns of one frame.
+    struct capture_display
+    {
+        static constexpr uint16_t column_count = display_type::column_count;
+
+        void push_column( uint8_t column)
+        {
+            columns.push_back( column);
+        }
+
+        std::vector<uint8_t> columns;
+    };
+
+    /// All columns of a text, followed by the gap before it repeats.
+    std::vector<uint8_t> reference_period( const char *text)
+    {
+        std::vector<uint8_t> result;
+        string_bits bits{ text};
+        while (not bits.at_end()) result.push_back( bits.next());
+        result.insert( result.end(), repeat_space, 0);
+        return result;
+    }
+
+    /// The window that the display shows at a position in the period.
+    std::vector<uint8_t> reference_window( const std::vector<uint8_t> &period, size_t position)
+    {
+        std::vector<uint8_t> result;
+        for (uint16_t column = 0; column < capture_display::column_count; ++column)
+        {
+            result.push_back( period[(position + column) % period.size()]);
+        }
+        return result;
+    }
+
+    template< typename cache_type>
+    void store( cache_type &cache, const char *text)
+    {
+        cache.store( text, strlen( text));
+        cache.rasterize();
+    }
+
+    /**
+     * Scroll a text through a bit more than two periods and return the
+     * frames, after checking each of them against the reference.
+     */
+    template< typename cache_type>
+    std::vector<std::vector<uint8_t>> check_scroll( const cache_type &cache, const char *text)
+    {
+        const auto period = reference_period( text);
+        CHECK( cache.width() + repeat_space == period.size());
+
+        std::vector<std::vector<uint8_t>> frames;
+        text_scroller< cache_type> scroller;
+        scroller.start( cache, repeat_space);
+        for (size_t position = 0; position < 2 * period.size() + 10; ++position)
+        {
+            capture_display display;
+            scroller.render( display);
+            CHECK( display.columns == reference_window( period, position));
+            frames.push_back( display.columns);
+            scroller.step();
+        }
+        return frames;
+    }
+
+    /// Deliver an mqtt message to the firmware.
+    void receive( const char *topic, const std::string &message)
+    {
+        const esp_link::packet packet{ std::string{ MQTT_BASE_NAME} + topic, message};
+        update( &packet, 0);
+    }
+}
+
+int main()
+{
+    const char *short_text = "Scrolling text!";
+    const char *long_text = "A text that is much too wide to fit in a small cache";
+
+    {
+        // the columns are rasterized in front of the text, without
+        // overwriting it.
+        column_cache<256> cache;
+        store( cache, short_text);
+        CHECK( cache.is_valid());
+        CHECK( strcmp( cache.text(), short_text) == 0);
+        const auto period = reference_period( short_text);
+        for (uint16_t column = 0; column < cache.width(); ++column)
+        {
+            CHECK( cache.column( column) == period[column]);
+        }
+
+        // a text that is too long to store is cut off.
+        const std::string too_long( 300, 'x');
+        cache.store( too_long.c_str(), too_long.size());
+        CHECK( strlen( cache.text()) == cache.max_text_length);
+        cache.rasterize();
+        CHECK( not cache.is_valid());
+        CHECK( cache.width() == reference_period( cache.text()).size() - repeat_space);
+    }
+
+    {
+        // the same text gives the same frames from the cache and from the string.
+        column_cache<256> large;
+        column_cache<64> small;
+        store( large, short_text);
+        store( small, short_text);
+        CHECK( large.is_valid() and not small.is_valid());
+        CHECK( check_scroll( large, short_text) == check_scroll( small, short_text));
+
+        // a text that only fits as a string.
+        store( small, long_text);
+        CHECK( not small.is_valid());
+        check_scroll( small, long_text);
+    }
+
+    {
+        // a frame replaces the text, a frame delta changes ranges of columns.
+        store( text_columns, short_text);
+        receive( "frame", "\x01\x02\x03");
+        CHECK( text_columns.is_valid());
+        CHECK( text_columns.width() == 3);
+        CHECK( *text_columns.text() == 0);
+
+        receive( "frameDelta", std::string{ "\x01\x01\xff\x04\x02\x10\x20", 7});
+        CHECK( text_columns.width() == 6);
+        const uint8_t expected[] = { 0x01, 0xff, 0x03, 0x00, 0x10, 0x20};
+        for (uint8_t column = 0; column < 6; ++column)
+        {
+            CHECK( text_columns.column( column) == expected[column]);
+        }
+
+        capture_display display;
+        text_columns.render( display);
+        CHECK( display.columns.size() == capture_display::column_count);
+        CHECK( std::vector<uint8_t>( display.columns.begin(), display.columns.begin() + 6)
+                == std::vector<uint8_t>( expected, expected + 6));
+        CHECK( display.columns[6] == 0);
+    }
+
+    return CHECK_RESULT();
+}
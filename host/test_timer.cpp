@@ -0,0 +1,90 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+
+/**
+ * Checks of Timer::Periodic, in particular for tasks that are not polled
+ * for a long time.
+ */
+#include "../timer.h"
+#include <host/board.hpp>
+#include <host/check.hpp>
+
+namespace
+{
+    constexpr uint32_t hour = 3600ul * Timer::ticksPerSecond;
+    constexpr uint32_t day = 24 * hour;
+}
+
+int main()
+{
+    constexpr uint16_t period = 156;
+
+    {
+        // a task that is on time is due once per period.
+        Timer::Periodic task;
+        CHECK( not task.IsDue( 1000));
+        task.Start( period);
+        const uint32_t start = host::ticks();
+        CHECK( not task.IsDue( start + period - 1));
+        CHECK( task.IsDue( start + period));
+        CHECK( not task.IsDue( start + period));
+        CHECK( task.IsDue( start + 2 * period + 10));
+
+        // a late task does not drift.
+        CHECK( not task.IsDue( start + 3 * period - 1));
+        CHECK( task.IsDue( start + 3 * period));
+
+        task.Stop();
+        CHECK( not task.IsDue( start + 10 * period));
+    }
+
+    {
+        // after a long time without polls, skip drops the missed periods at once and
+        // keeps the phase of the original deadlines.
+        for (const uint32_t idle : { hour, day, 3 * day})
+        {
+            Timer::Periodic task;
+            task.Start( period);
+            const uint32_t start = host::ticks();
+            const uint32_t now = start + idle;
+            CHECK( task.IsDue( now));
+            CHECK( not task.IsDue( now));
+
+            const uint32_t next = start + (idle / period + 1) * period;
+            CHECK( not task.IsDue( next - 1));
+            CHECK( task.IsDue( next));
+        }
+    }
+
+    {
+        // catch up returns true for every missed period.
+        Timer::Periodic task{ 0, Timer::Periodic::CatchUp};
+        task.Start( period);
+        const uint32_t start = host::ticks();
+        uint16_t count = 0;
+        while (task.IsDue( start + 10 * period)) ++count;
+        CHECK( count == 10);
+    }
+
+    {
+        // a deadline more than 2^31 ticks in the past is not seen, so such a
+        // task must be restarted, after which it is due again after one period.
+        Timer::Periodic task;
+        task.Start( period);
+        const uint32_t deadline = host::ticks() + period;
+        CHECK( not task.IsDue( deadline + 0x80000000ul));
+
+        host::advance_ticks( 1000);
+        task.Start( period);
+        const uint32_t start = host::ticks();
+        CHECK( not task.IsDue( start + period - 1));
+        CHECK( task.IsDue( start + period));
+    }
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,185 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef LED_TIMELINE_HPP_
+#define LED_TIMELINE_HPP_
+#include <ws2811/rgb.h>
+#include "easing.hpp"
+
+/**
+ * One step of a led timeline: fade the leds first..last (inclusive) from
+ * their current color to a target color in a number of frames.
+ */
+struct led_keyframe
+{
+    uint8_t     first;
+    uint8_t     last;
+    ws2811::rgb to;
+    uint16_t    duration;       // in frames
+    uint8_t     curve:2;        // an easing::Curve
+    uint8_t     with_previous:1;// start at the same time as the previous keyframe
+};
+
+/**
+ * Plays a sequence of keyframes on a led strip, one frame per call to step().
+ *
+ * Consecutive keyframes that are marked with_previous form a group with the
+ * keyframe before them. The keyframes of a group play at the same time and
+ * the next group starts when the longest keyframe of the group has finished.
+ *
+ * The start color of a keyframe is not stored. Every frame, a keyframe
+ * continues from the current color of its first led and covers the part of
+ * the remaining distance to its target color that its curve asks for. The
+ * whole range gets the color of the first led, so a keyframe works best
+ * on ranges of a single color.
+ */
+template< uint8_t capacity>
+class led_timeline
+{
+public:
+    void clear()
+    {
+        m_count = 0;
+        m_playing = false;
+    }
+
+    /**
+     * Add a keyframe at the end of the timeline. Returns false if
+     * the timeline is full.
+     */
+    bool add( const led_keyframe &key)
+    {
+        if (m_count == capacity) return false;
+        m_keys[m_count++] = key;
+        return true;
+    }
+
+    /**
+     * Start playing from the first keyframe. If loop is true, the timeline
+     * restarts after the last keyframe until it is stopped.
+     */
+    void start( bool loop)
+    {
+        m_loop = loop;
+        m_playing = m_count != 0;
+        m_group = 0;
+        m_elapsed = 0;
+    }
+
+    void stop()
+    {
+        m_playing = false;
+    }
+
+    /**
+     * Play one frame of the timeline. Returns true if leds were changed.
+     */
+    template< size_t size>
+    bool step( ws2811::rgb (&leds)[size])
+    {
+        if (not m_playing) return false;
+
+        if (m_elapsed == 0)
+        {
+            start_group();
+        }
+        ++m_elapsed;
+
+        for (uint8_t index = m_group; index < m_group_end; ++index)
+        {
+            render( m_keys[index], leds);
+        }
+
+        if (m_elapsed >= m_group_duration)
+        {
+            m_elapsed = 0;
+            m_group = m_group_end;
+            if (m_group == m_count)
+            {
+                m_group = 0;
+                m_playing = m_loop;
+            }
+        }
+        return true;
+    }
+
+private:
+    void start_group()
+    {
+        m_group_duration = 0;
+        m_group_end = m_group;
+        do
+        {
+            const auto &key = m_keys[m_group_end];
+            if (key.duration > m_group_duration) m_group_duration = key.duration;
+            ++m_group_end;
+        }
+        while (m_group_end < m_count and m_keys[m_group_end].with_previous);
+    }
+
+    /**
+     * Progress of a keyframe after a number of frames, from 0 to 255, after easing.
+     */
+    static uint8_t progress( const led_keyframe &key, uint16_t elapsed)
+    {
+        if (elapsed >= key.duration) return 255;
+        return easing::apply(
+                static_cast<easing::Curve>( key.curve),
+                static_cast<uint32_t>( elapsed) * 255 / key.duration);
+    }
+
+    /**
+     * Move a color component the part covered/remaining of the way to a target,
+     * rounded to the nearest value so that the small steps of consecutive
+     * frames do not lag behind.
+     */
+    static uint8_t approach( uint8_t value, uint8_t target, uint8_t covered, uint8_t remaining)
+    {
+        const int32_t step = static_cast<int32_t>( static_cast<int16_t>( target) - value) * covered;
+        const int16_t half = remaining / 2;
+        return value + (step + (step < 0 ? -half : half)) / remaining;
+    }
+
+    template< size_t size>
+    void render( const led_keyframe &key, ws2811::rgb (&leds)[size]) const
+    {
+        if (key.first >= size) return;
+
+        // this frame covers the part (current - previous) of the remaining
+        // distance (255 - previous) from the first led to the target.
+        const uint8_t previous = progress( key, m_elapsed - 1);
+        const uint8_t current = progress( key, m_elapsed);
+        uint8_t covered = 1;
+        uint8_t remaining = 1;
+        if (previous != 255)
+        {
+            covered = current > previous ? current - previous : 0;
+            remaining = 255 - previous;
+        }
+
+        const auto &now = leds[key.first];
+        const ws2811::rgb color{
+            approach( now.red,   key.to.red,   covered, remaining),
+            approach( now.green, key.to.green, covered, remaining),
+            approach( now.blue,  key.to.blue,  covered, remaining)};
+        for (uint16_t led = key.first; led <= key.last and led < size; ++led)
+        {
+            leds[led] = color;
+        }
+    }
+
+    led_keyframe m_keys[capacity];
+    uint8_t      m_count = 0;
+    uint8_t      m_group = 0;
+    uint8_t      m_group_end = 0;
+    uint16_t     m_elapsed = 0;
+    uint16_t     m_group_duration = 0;
+    bool         m_playing = false;
+    bool         m_loop = false;
+};
+
+#endif /* LED_TIMELINE_HPP_ */
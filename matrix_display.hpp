@@ -0,0 +1,344 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef MATRIX_DISPLAY_HPP_
+#define MATRIX_DISPLAY_HPP_
+#include <avr_utilities/pin_definitions.hpp>
+#include <stdint.h>
+#include <string.h>
+
+namespace matrix_display_detail
+{
+    // the display class has its own clear(), which would hide the
+    // clear() that works on pins.
+    template< typename pin_type>
+    void select( pin_type &pin)
+    {
+        clear( pin);
+    }
+}
+
+/**
+ * Describes how an spi type sends bytes to one or more daisy chains.
+ *
+ * Spi types with a static member chain_count, like parallel_spi, send one byte to
+ * each of their chains at once through transmit( const uint8_t *). All other spi types
+ * drive a single chain through transmit( uint8_t).
+ */
+template< typename spi_type, typename enable = void>
+struct spi_chains
+{
+    static constexpr uint8_t count = 1;
+
+    static void transmit( const uint8_t *values)
+    {
+        spi_type::transmit( *values);
+    }
+};
+
+template< typename spi_type>
+struct spi_chains< spi_type, decltype( void( spi_type::chain_count))>
+{
+    static constexpr uint8_t count = spi_type::chain_count;
+
+    static void transmit( const uint8_t *values)
+    {
+        spi_type::transmit( values);
+    }
+};
+
+/**
+ * How the digit registers of a max7219 map onto the pixels of its 8x8 matrix.
+ *
+ * A wiring offers digit_value(), which returns the register value of a digit
+ * for the eight columns of one matrix. Bit y of a column is the pixel in row y.
+ *
+ * With column_wiring, digit n drives column n of the matrix and bit y of the
+ * register drives row y. This is how the matrices of this display are wired.
+ */
+struct column_wiring
+{
+    static uint8_t digit_value( const uint8_t *matrix_columns, uint8_t digit)
+    {
+        return matrix_columns[digit];
+    }
+};
+
+/**
+ * With row_wiring, digit n drives row n of the matrix, and the most significant
+ * bit of the register drives the leftmost column. Many ready-made modules with
+ * four matrices are wired this way.
+ */
+struct row_wiring
+{
+    static uint8_t digit_value( const uint8_t *matrix_columns, uint8_t digit)
+    {
+        const uint8_t mask = 1 << digit;
+        uint8_t value = 0;
+        for (uint8_t column = 0; column < 8; ++column)
+        {
+            value <<= 1;
+            if (matrix_columns[column] & mask) value |= 1;
+        }
+        return value;
+    }
+};
+
+/**
+ * Display buffer for a daisy chain of 8x8 led matrices, each driven by a max7219.
+ *
+ * The buffer holds the display as columns of 8 pixels. The wiring type, e.g.
+ * column_wiring or row_wiring, decides how those columns become the values of
+ * the max7219 digit registers. The first matrix in the chain, the one connected
+ * to the controller, shows the leftmost columns.
+ *
+ * If the spi type drives several chains in parallel, the matrices are divided
+ * evenly over the chains. The first chain shows the leftmost matrices.
+ *
+ * Sending data to the chain is by far the most expensive part of drawing a frame.
+ * This class therefore keeps a copy of the register values that were last sent
+ * to each chip and transmit() only sends the digits that have changed since then. Chips whose digit
+ * did not change receive a no-op command. A frame that is identical to
+ * the previous one is not sent at all.
+ *
+ * A frame can also be sent in steps, so that other work, like receiving data, can
+ * continue while the frame is being sent. After start_transmit(), each call of
+ * transmit_step() sends a single digit. Digits are sent straight from the buffer,
+ * so the buffer must not change until transmit_done() returns true. Drawing a new
+ * frame starts with clear(), which first sends what remains of the previous frame.
+ *
+ * The spi_type must offer a static function init() and transmit functions as
+ * described for spi_chains.
+ */
+template< uint8_t matrix_count, typename spi_type, typename csk_type, typename wiring = column_wiring>
+class matrix_display
+{
+public:
+    static constexpr uint16_t column_count = matrix_count * 8;
+
+private:
+    using chains = spi_chains<spi_type>;
+    static constexpr uint8_t chain_length = matrix_count / chains::count;
+    static_assert( chain_length * chains::count == matrix_count,
+            "the matrices must be evenly divided over the chains");
+
+public:
+
+    /// Brightness after initialization, from 0 to 15.
+    static constexpr uint8_t default_intensity = 7;
+
+    /**
+     * Initialize every register of every matrix. The chips keep their registers
+     * when only the controller resets, so nothing is left to their power-up state.
+     */
+    matrix_display()
+    {
+        make_output( csk);
+        set( csk);
+        spi_type::init();
+
+        send_to_all( DisplayTest, 0);
+        send_to_all( ScanLimit, 7);
+        send_to_all( DecodeMode, 0);
+        send_to_all( Intensity, default_intensity);
+        for (uint8_t digit = 0; digit < 8; ++digit)
+        {
+            send_to_all( Digit0 + digit, 0);
+        }
+        send_to_all( Shutdown, 1);
+    }
+
+    /**
+     * Clear the buffer and move the cursor to the leftmost column.
+     *
+     * A frame that is still being sent is completed first. Apart from that,
+     * this does not change the display until the next call of transmit().
+     */
+    void clear()
+    {
+        flush();
+        memset( columns, 0, column_count);
+        cursor = 0;
+    }
+
+    /**
+     * Write a column at the cursor position and move the cursor one
+     * column to the right.
+     *
+     * If the cursor is beyond the rightmost column and auto shift is on,
+     * all columns are first shifted one position to the left. Otherwise
+     * the column is ignored.
+     */
+    void push_column( uint8_t column)
+    {
+        if (cursor >= column_count)
+        {
+            if (not do_auto_shift) return;
+            memmove( columns, columns + 1, column_count - 1);
+            cursor = column_count - 1;
+        }
+        columns[cursor++] = column;
+    }
+
+    void set_pixel( uint8_t x, uint8_t y)
+    {
+        if (x < column_count and y < 8)
+        {
+            columns[x] |= 1 << y;
+        }
+    }
+
+    void auto_shift( bool value)
+    {
+        do_auto_shift = value;
+    }
+
+    /**
+     * Send all digits that differ from the last transmitted frame to the
+     * display and return when done.
+     */
+    void transmit()
+    {
+        start_transmit();
+        flush();
+    }
+
+    /**
+     * Queue the current buffer for transmission by transmit_step().
+     */
+    void start_transmit()
+    {
+        next_digit = 0;
+    }
+
+    /**
+     * Send the next changed digit of the queued frame, if any.
+     *
+     * Returns true if there may be more digits to send.
+     */
+    bool transmit_step()
+    {
+        while (next_digit < 8)
+        {
+            const auto digit = next_digit++;
+            if (digit_changed( digit))
+            {
+                transmit_digit( digit);
+                return next_digit < 8;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Send what remains of the queued frame.
+     */
+    void flush()
+    {
+        while (transmit_step()) /* continue */;
+    }
+
+    /**
+     * Return true if the queued frame has been sent completely.
+     */
+    bool transmit_done() const
+    {
+        return next_digit >= 8;
+    }
+
+    void enable( bool on)
+    {
+        send_to_all( Shutdown, on);
+    }
+
+    void brightness( uint8_t value)
+    {
+        send_to_all( Intensity, value & 0x0f);
+    }
+
+private:
+    enum Register : uint8_t
+    {
+        NoOp        = 0x00,
+        Digit0      = 0x01,
+        DecodeMode  = 0x09,
+        Intensity   = 0x0a,
+        ScanLimit   = 0x0b,
+        Shutdown    = 0x0c,
+        DisplayTest = 0x0f
+    };
+
+    bool digit_changed( uint8_t digit) const
+    {
+        for (uint16_t matrix = 0; matrix < column_count; matrix += 8)
+        {
+            if (wiring::digit_value( columns + matrix, digit) != shadow[matrix + digit]) return true;
+        }
+        return false;
+    }
+
+    /**
+     * Send one digit of the frame to all matrices that need it and a no-op to the others.
+     *
+     * The first word that is shifted into a chain ends up in its last matrix,
+     * so the matrices are visited from last to first.
+     */
+    void transmit_digit( uint8_t digit)
+    {
+        uint8_t registers[chains::count];
+        uint8_t values[chains::count];
+
+        matrix_display_detail::select( csk);
+        for (uint8_t position = chain_length; position--;)
+        {
+            for (uint8_t chain = 0; chain < chains::count; ++chain)
+            {
+                const uint16_t matrix = (chain * chain_length + position) * 8;
+                const uint8_t value = wiring::digit_value( columns + matrix, digit);
+                if (value != shadow[matrix + digit])
+                {
+                    shadow[matrix + digit] = value;
+                    registers[chain] = Digit0 + digit;
+                    values[chain] = value;
+                }
+                else
+                {
+                    registers[chain] = NoOp;
+                    values[chain] = 0;
+                }
+            }
+            chains::transmit( registers);
+            chains::transmit( values);
+        }
+        set( csk);
+    }
+
+    void send_to_all( uint8_t reg, uint8_t value)
+    {
+        uint8_t registers[chains::count];
+        uint8_t values[chains::count];
+        memset( registers, reg, chains::count);
+        memset( values, value, chains::count);
+
+        matrix_display_detail::select( csk);
+        for (uint8_t position = 0; position < chain_length; ++position)
+        {
+            chains::transmit( registers);
+            chains::transmit( values);
+        }
+        set( csk);
+    }
+
+    csk_type csk;
+    bool     do_auto_shift = true;
+    uint16_t cursor = 0;
+    uint8_t  next_digit = 8;
+    uint8_t  columns[column_count] = {0};  ///< the frame that is drawn and sent
+    uint8_t  shadow[column_count] = {0};   ///< the digit registers of each chip, 8 per chip
+};
+
+#endif /* MATRIX_DISPLAY_HPP_ */
@@ -0,0 +1,88 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef PARALLEL_SPI_HPP_
+#define PARALLEL_SPI_HPP_
+#include <stdint.h>
+
+/**
+ * Bit-banged, transmit-only spi that drives up to 8 daisy chains at the same time.
+ *
+ * All chains share one clock pin. Each chain has its own data pin, on the same
+ * port as the clock. Every clock edge is a single store to the port, so sending a
+ * byte to each of N chains takes as long as sending a byte to one chain. Bits are
+ * sent most significant bit first and are latched on the rising clock edge.
+ *
+ * The port_type must offer static functions port() and ddr() that return
+ * the PORTx and DDRx registers of the port, e.g.:
+ *
+ *     struct port_b
+ *     {
+ *         static volatile uint8_t &port() { return PORTB;}
+ *         static volatile uint8_t &ddr()  { return DDRB;}
+ *     };
+ *
+ * The other pins of the port keep their value, but must not be changed by
+ * interrupt handlers while a byte is being sent.
+ */
+template< typename port_type, uint8_t clk_bit, uint8_t... data_bits>
+struct parallel_spi
+{
+    static constexpr uint8_t chain_count = sizeof...( data_bits);
+    static_assert( chain_count > 0 and chain_count <= 8, "parallel_spi drives 1 to 8 chains");
+
+    static void init()
+    {
+        port_type::port() &= ~(clk_mask | data_mask());
+        port_type::ddr() |= clk_mask | data_mask();
+    }
+
+    /**
+     * Send values[n] to chain n, for all chains at the same time.
+     */
+    static void transmit( const uint8_t *values)
+    {
+        static constexpr uint8_t masks[] = { (1 << data_bits)...};
+
+        const uint8_t other_pins = port_type::port() & ~(clk_mask | data_mask());
+        for (uint8_t bit = 0x80; bit; bit >>= 1)
+        {
+            uint8_t out = other_pins;
+            for (uint8_t chain = 0; chain < chain_count; ++chain)
+            {
+                if (values[chain] & bit)
+                {
+                    out |= masks[chain];
+                }
+            }
+            port_type::port() = out;
+            port_type::port() = out | clk_mask;
+        }
+        port_type::port() = other_pins;
+    }
+
+private:
+    static constexpr uint8_t clk_mask = 1 << clk_bit;
+
+    static constexpr uint8_t data_mask()
+    {
+        return combine( (1 << data_bits)...);
+    }
+
+    static constexpr uint8_t combine()
+    {
+        return 0;
+    }
+
+    template< typename... masks_type>
+    static constexpr uint8_t combine( uint8_t mask, masks_type... rest)
+    {
+        return mask | combine( rest...);
+    }
+};
+
+#endif /* PARALLEL_SPI_HPP_ */
@@ -0,0 +1,161 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef PARTICLES_HPP_
+#define PARTICLES_HPP_
+#include <stdint.h>
+
+/**
+ * Draw a single particle at fixed point position x,y, if that position
+ * is on the display.
+ */
+template< uint8_t fraction_bits, typename display_type>
+void plot_particle( display_type &display, int16_t x, int16_t y)
+{
+    if (x >= 0 and y >= 0)
+    {
+        const uint16_t column = x >> fraction_bits;
+        const uint16_t row = y >> fraction_bits;
+        if (column < display_type::column_count and row < 8)
+        {
+            display.set_pixel( column, row);
+        }
+    }
+}
+
+/**
+ * Horizontal velocities of the particles of a particle_system, if they have any.
+ */
+template< uint8_t capacity, bool stored>
+struct horizontal_velocities
+{
+    int8_t get( uint8_t index) const
+    {
+        return m_vx[index];
+    }
+
+    void set( uint8_t index, int8_t vx)
+    {
+        m_vx[index] = vx;
+    }
+
+    int8_t m_vx[capacity];
+};
+
+template< uint8_t capacity>
+struct horizontal_velocities< capacity, false>
+{
+    int8_t get( uint8_t) const
+    {
+        return 0;
+    }
+
+    void set( uint8_t, int8_t)
+    {}
+};
+
+/**
+ * A set of particles that move across a matrix display.
+ *
+ * Positions and velocities are fixed point numbers with config::fraction_bits
+ * fractional bits. They are stored in separate arrays, and the live particles
+ * always occupy the first count() entries: a particle that dies is replaced
+ * by the last live one. Stepping and rendering therefore only visit live
+ * particles, whatever the capacity.
+ *
+ * The config type provides:
+ *   - fraction_bits, the amount of fractional bits of positions and velocities,
+ *   - x_end, the horizontal size of the area in which particles live,
+ *   - clip_x, whether particles die when they move outside that area horizontally,
+ *   - has_vx, whether particles have their own horizontal velocity. Without it,
+ *     particles only move horizontally with the wind and no velocities are stored.
+ * Particles always die when they fall below the display.
+ */
+template< uint8_t capacity, typename config>
+class particle_system
+{
+public:
+    static constexpr uint8_t fraction_bits = config::fraction_bits;
+    static constexpr int16_t y_end = 8 << fraction_bits;
+
+    /**
+     * Add a particle. Returns false if there is no room for it.
+     */
+    bool add( int16_t x, int16_t y, int8_t vx, int8_t vy)
+    {
+        if (m_count == capacity) return false;
+        m_x[m_count]  = x;
+        m_y[m_count]  = y;
+        m_vx.set( m_count, vx);
+        m_vy[m_count] = vy;
+        ++m_count;
+        return true;
+    }
+
+    /**
+     * Move all particles by their velocity and accelerate them downward
+     * by gravity. The first 'split' particles are also moved horizontally
+     * by wind1, the others by wind2.
+     */
+    void step( int8_t gravity, int8_t wind1 = 0, int8_t wind2 = 0, uint8_t split = 0)
+    {
+        uint8_t index = 0;
+        while (index < m_count)
+        {
+            m_x[index] += m_vx.get( index) + (index < split ? wind1 : wind2);
+            m_y[index] += m_vy[index];
+            m_vy[index] += gravity;
+
+            if (is_outside( index))
+            {
+                remove( index);
+            }
+            else
+            {
+                ++index;
+            }
+        }
+    }
+
+    template< typename display_type>
+    void render( display_type &display) const
+    {
+        for (uint8_t index = 0; index < m_count; ++index)
+        {
+            plot_particle<fraction_bits>( display, m_x[index], m_y[index]);
+        }
+    }
+
+    uint8_t count() const
+    {
+        return m_count;
+    }
+
+private:
+    bool is_outside( uint8_t index) const
+    {
+        return m_y[index] >= y_end
+                or (config::clip_x and (m_x[index] < 0 or m_x[index] >= config::x_end));
+    }
+
+    void remove( uint8_t index)
+    {
+        --m_count;
+        m_x[index]  = m_x[m_count];
+        m_y[index]  = m_y[m_count];
+        m_vx.set( index, m_vx.get( m_count));
+        m_vy[index] = m_vy[m_count];
+    }
+
+    uint8_t m_count = 0;
+    int16_t m_x[capacity];
+    int16_t m_y[capacity];
+    int8_t  m_vy[capacity];
+    horizontal_velocities< capacity, config::has_vx> m_vx;
+};
+
+#endif /* PARTICLES_HPP_ */
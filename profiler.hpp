@@ -0,0 +1,158 @@
+//
+//  Copyright (C) 2019 Danny Havenith
+//
+//  Distributed under the Boost Software License, Version 1.0. (See
+//  accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef PROFILER_HPP_
+#define PROFILER_HPP_
+#include "timer.h"
+
+/**
+ * Optional instrumentation of the main loop.
+ *
+ * Define WIFIMATRIX_PROFILE to measure how long each phase of the main loop takes, in
+ * timer ticks of 128us. Without it, the profiler and its scopes are empty classes
+ * that the compiler removes completely.
+ */
+namespace profiling
+{
+    enum Phase : uint8_t
+    {
+        Receive,        // once per pass of the main loop
+        TransmitStep,   // sending one digit, once per pass of the main loop
+        Leds,
+        LedSend,
+        Flush,          // sending what remains of the previous frame
+        Text,           // clearing the display and rendering the text
+        SnowStep,
+        SnowRender,
+        FireworksStep,
+        FireworksRender,
+        PhaseCount // end of sequence
+    };
+
+#ifdef WIFIMATRIX_PROFILE
+
+    struct phase_stats
+    {
+        uint16_t min;
+        uint16_t max;
+        uint32_t total;
+        uint32_t count; // phases that run every pass of the main loop have many samples
+
+        uint16_t mean() const
+        {
+            return count ? total / count : 0;
+        }
+    };
+
+    class frame_profiler
+    {
+    public:
+        /**
+         * Measures the time between its construction and
+         * destruction as one sample of a phase.
+         */
+        class scope
+        {
+        public:
+            scope( frame_profiler &profiler, Phase phase)
+            :m_profiler( profiler), m_phase{ phase}, m_start{ Timer::GetCurrent()}
+            {}
+
+            ~scope()
+            {
+                m_profiler.add( m_phase, Timer::GetCurrent() - m_start);
+            }
+
+        private:
+            frame_profiler &m_profiler;
+            Phase           m_phase;
+            uint16_t        m_start;
+        };
+
+        frame_profiler()
+        {
+            reset();
+        }
+
+        /**
+         * Register the start of a frame. A frame that starts more than one and
+         * a half periods after the previous one counts as a missed deadline.
+         */
+        void frame_started( uint16_t period)
+        {
+            const auto now = Timer::GetCurrent();
+            if (static_cast<uint16_t>( now - m_last_frame) > period + period / 2)
+            {
+                ++m_missed;
+            }
+            m_last_frame = now;
+        }
+
+        void add( Phase phase, uint16_t duration)
+        {
+            auto &stats = m_stats[phase];
+            if (duration < stats.min) stats.min = duration;
+            if (duration > stats.max) stats.max = duration;
+            stats.total += duration;
+            ++stats.count;
+        }
+
+        const phase_stats &stats( Phase phase) const
+        {
+            return m_stats[phase];
+        }
+
+        uint16_t missed() const
+        {
+            return m_missed;
+        }
+
+        void reset()
+        {
+            for (uint8_t phase = 0; phase < PhaseCount; ++phase)
+            {
+                reset( static_cast<Phase>( phase));
+            }
+            reset_missed();
+        }
+
+        void reset( Phase phase)
+        {
+            m_stats[phase] = { 0xffff, 0, 0, 0};
+        }
+
+        void reset_missed()
+        {
+            m_missed = 0;
+        }
+
+    private:
+        phase_stats m_stats[PhaseCount];
+        uint16_t    m_missed = 0;
+        uint16_t    m_last_frame = 0;
+    };
+
+#else
+
+    class frame_profiler
+    {
+    public:
+        class scope
+        {
+        public:
+            scope( frame_profiler &, Phase)
+            {}
+        };
+
+        void frame_started( uint16_t)
+        {}
+    };
+
+#endif
+}
+
+#endif /* PROFILER_HPP_ */
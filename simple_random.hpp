@@ -8,23 +8,45 @@
 #ifndef SIMPLE_RANDOM_HPP_
 #define SIMPLE_RANDOM_HPP_
 
-/// very crude pseudo random generator
-inline uint16_t my_rand()
+/// state of the random generator, shared by all users.
+/// The state is never zero.
+inline uint16_t &random_state()
 {
-    static uint16_t state;
-    return state += 13331; // adding a prime number
+    static uint16_t state = 1;
+    return state;
 }
 
-inline int16_t plusminus( int16_t range)
+/// Restart the random sequence. Effects that only use my_rand() will produce
+/// exactly the same output after the same seed.
+inline void seed_random( uint16_t seed)
 {
-    return my_rand() % (2 * range + 1) - range;
+    // zero is the one state that a xorshift generator never leaves.
+    random_state() = seed ? seed : 1;
 }
 
+/// 16-bit xorshift pseudo random generator, with a period of 2^16 - 1.
+inline uint16_t my_rand()
+{
+    auto &state = random_state();
+    state ^= state << 7;
+    state ^= state >> 9;
+    state ^= state << 8;
+    return state;
+}
 
-
+/// Return a random number in the range [0, range).
+///
+/// This scales a random number with a multiplication instead of taking a
+/// remainder, because the avr has a hardware multiplier, but no divider.
 inline uint16_t no_more_than( uint16_t range)
 {
-    return my_rand() % range;
+    return (static_cast<uint32_t>( my_rand()) * range) >> 16;
+}
+
+/// Return a random number in the range [-range, range].
+inline int16_t plusminus( int16_t range)
+{
+    return no_more_than( 2 * range + 1) - range;
 }
 
 inline int16_t plusminus( int16_t offset, int16_t range)
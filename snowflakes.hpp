@@ -8,6 +8,7 @@
 #ifndef SNOWFLAKES_HPP_
 #define SNOWFLAKES_HPP_
 #include "simple_random.hpp"
+#include "particles.hpp"
 
 /**
  * This class animates a number of "snow flakes" across a matrix display.
@@ -19,112 +20,52 @@
  * moves up and down. The first n flakes are influenced by wind1 while
  * the next count - n flakes are influenced by wind2.
  *
- * All positions and speeds are kept in fixed point numbers.
+ * Snow is a particle_system without gravity in which the particles die when
+ * they are blown off the display.
  */
 template<typename display_type>
 class snowflakes_type
 {
 public:
 
-    bool render( display_type &display, bool create_new = true)
+    /**
+     * Move all snowflakes. If create_new is true, snowflakes that have left
+     * the display are replaced by new ones.
+     *
+     * Returns false if no more snowflakes are visible.
+     */
+    bool step( bool create_new = true)
     {
         update_wind();
+        flakes.step( 0, wind1, wind2, threshold);
 
-        bool active = false;
-        for ( uint8_t i = 0; i < count; ++i)
+        if (create_new)
         {
-            auto &flake = flakes[i];
-
-            flake.step();
-            if (flake.at_end())
-            {
-                if (create_new)
-                {
-                    flake = random_snowflake();
-                    active = true;
-                }
-            }
-            else
-            {
-                active = true;
-            }
-            if (i < threshold)
+            while (flakes.add(
+                    no_more_than( display_type::column_count * 16), // x
+                    0,                                              // y
+                    0,                                              // vx
+                    1 + no_more_than( 4)))                          // vy
             {
-                flake.offset_x( wind1);
+                /* continue */
             }
-            else
-            {
-                flake.offset_x( wind2);
-            }
-            flake.render( display);
         }
-        return active;
+        return flakes.count() != 0;
     }
 
-private:
-
-    class snowflake
+    void render( display_type &display) const
     {
-    public:
-        snowflake()
-        :x{0}, y{y_end}, vy{0}
-        {
-
-        }
-        snowflake( int16_t x, uint8_t vy)
-        :x{x}, y{0}, vy{vy}
-        {
-        }
-
-        void step( )
-        {
-            if (not at_end())
-            {
-                y += vy;
-            }
-        }
-
-        void offset_x( int8_t offset)
-        {
-            x += offset;
-            if (x < 0 or x >= static_cast<int16_t>(display_type::column_count * x_scale))
-            {
-                x = 0;
-                y = y_end;
-            }
-        }
-
-        void render( display_type &display)
-        {
-            if (not at_end())
-            {
-                display.set_pixel( x / x_scale, y / y_scale);
-            }
-        }
-
-        bool at_end() const
-        {
-            return y >= y_end;
-        }
-
-    private:
-        static constexpr uint8_t x_scale = 16;
-        static constexpr uint8_t y_scale = 16;
-        static constexpr uint8_t y_end = 8 * y_scale;
-
-        int16_t x; // in 10.6 fixed point
-        uint8_t y;  // in 4.4 fixed point
-        uint8_t vy; // in 4.4 fixed point
-    };
+        flakes.render( display);
+    }
 
-    static snowflake random_snowflake()
+private:
+    struct config
     {
-        return
-            {
-                static_cast<int16_t>( my_rand()%(display_type::column_count *16)),
-                static_cast<uint8_t>( 1 + my_rand()%4)
-            };
-    }
+        static constexpr uint8_t  fraction_bits = 4;
+        static constexpr int16_t  x_end = display_type::column_count * 16;
+        static constexpr bool     clip_x = true;
+        static constexpr bool     has_vx = false;
+    };
 
     void update_wind()
     {
@@ -145,7 +86,7 @@ private:
     /// wind1, resp. wind2
     int8_t threshold = count/2;
 
-    snowflake flakes[20];
+    particle_system<count, config> flakes;
 
     int8_t wind1 = 0;
     int8_t wind2 = -3;
@@ -9,8 +9,20 @@
 
 #include "timer.h"
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include <avr_utilities/pin_definitions.hpp>
 
+namespace
+{
+	/// upper 16 bits of the 32-bit tick count
+	volatile uint16_t overflowCount = 0;
+}
+
+ISR( TIMER1_OVF_vect)
+{
+	++overflowCount;
+}
 
 struct InitTimer
 {
@@ -18,6 +30,7 @@ struct InitTimer
 	{
 		TCCR1A = 0;
 		TCCR1B = 5; // clk/1024
+		TIMSK1 = _BV( TOIE1);
 	}
 } timerstarter;
 
@@ -86,4 +99,50 @@ namespace Timer
         return { passedValue.endValue + ticks, passedValue.endValue};
     }
 
+	/**
+	 * Return the amount of ticks since startup, extended to 32 bits with
+	 * the count of timer overflows.
+	 */
+	uint32_t GetTicks()
+	{
+		uint16_t high;
+		uint16_t low;
+		ATOMIC_BLOCK( ATOMIC_RESTORESTATE)
+		{
+			high = overflowCount;
+			low = TCNT1;
+
+			// an overflow that happened after interrupts were disabled
+			// has not been counted yet.
+			if ((TIFR1 & _BV( TOV1)) and low < 0x8000)
+			{
+				++high;
+			}
+		}
+		return (static_cast<uint32_t>( high) << 16) | low;
+	}
+
+	void Periodic::Start( uint16_t newPeriod)
+	{
+		period = newPeriod;
+		next = GetTicks() + newPeriod;
+	}
+
+	bool Periodic::IsDue( uint32_t now)
+	{
+		if (not period or static_cast<int32_t>( now - next) < 0)
+		{
+			return false;
+		}
+
+		next += period;
+		if (policy == Skip and static_cast<int32_t>( now - next) >= 0)
+		{
+			// jump to the first deadline after now at once, a task that
+			// was not polled for a long time may have missed many periods.
+			next += (( now - next) / period + 1) * period;
+		}
+		return true;
+	}
+
 }
@@ -24,6 +24,63 @@ namespace Timer
 
 	constexpr uint16_t ticksPerSecond = 7812;
 	constexpr TimerWaitValue always = {0,0};
+
+	uint32_t GetTicks();
+
+	/**
+	 * Deadline of a task that runs with a fixed period.
+	 *
+	 * Deadlines are kept in 32-bit ticks, which wrap after more than six days, and
+	 * each next deadline is computed from the previous one instead of from
+	 * the current time, so that a task that runs late does not drift.
+	 *
+	 * If a task is late by more than one period, policy CatchUp makes IsDue() return
+	 * true for every missed period, while policy Skip drops the missed periods.
+	 *
+	 * A deadline that is more than 2^31 ticks (about three days) in the past looks
+	 * like one in the future. A task that is not polled for a long time, for instance
+	 * because its animation is off, must be restarted with Start() when it is needed again.
+	 */
+	class Periodic
+	{
+	public:
+		enum Policy : uint8_t
+		{
+			CatchUp,
+			Skip
+		};
+
+		Periodic( uint16_t period = 0, Policy policy = Skip)
+		:next{0}, period{period}, policy{policy}
+		{}
+
+		/**
+		 * (Re)start the task with the given period, counting from now.
+		 * A period of zero stops the task.
+		 */
+		void Start( uint16_t newPeriod);
+
+		void Stop()
+		{
+			period = 0;
+		}
+
+		bool IsRunning() const
+		{
+			return period != 0;
+		}
+
+		/**
+		 * Return true if the task is due at time 'now' and move the
+		 * deadline to the next period.
+		 */
+		bool IsDue( uint32_t now);
+
+	private:
+		uint32_t next;
+		uint16_t period;
+		Policy   policy;
+	};
 }
 
 #endif /* TIMER_H_ */
@@ -8,22 +8,27 @@
 #include <avr_utilities/esp-link/client.hpp>
 #include <avr_utilities/pin_definitions.hpp>
 #include <avr_utilities/esp-link/command.hpp>
-#include <avr_utilities/devices/max7219_matrix_display.hpp>
 #include <avr_utilities/devices/bitbanged_spi.h>
 #include <avr_utilities/font5x8.hpp>
 #include <avr_utilities/simple_text_parsing.h>
 
-#include "flare.hpp"
+#include "flare_pool.hpp"
+#include "led_timeline.hpp"
+#include "matrix_display.hpp"
+#include "profiler.hpp"
+#include "glyph_index.hpp"
 #define WS2811_PORT PORTB
 #include <ws2811/ws2811.h>
 #include <ws2811/rgb.h>
 #include <effects/water_torture.hpp>
 
 #include <avr/pgmspace.h>
+#include <avr/eeprom.h>
 #include <string.h>
 #include <util/delay.h>
 #include "timer.h"
 #include "snowflakes.hpp"
+#include "particles.hpp"
 #include "simple_random.hpp"
 
 #define MQTT_BASE_NAME "matrix/"
@@ -54,15 +59,128 @@ struct spi_pins
 static constexpr uint8_t ws2811_pin = 1;
 static constexpr uint8_t led_count = 60;
 static constexpr uint8_t flare_count = 20;
+static constexpr uint8_t keyframe_count = 8;
 
 // this display has 9 matrices, talks through bit-banged spi and uses B4 as cs pin.
+// Longer displays can be split over several chains that are driven at the same time
+// by using a parallel_spi (parallel_spi.hpp), e.g. parallel_spi<port_b, 5, 3, 2> for
+// two chains with their data pins on B3 and B2. A hardware_spi (hardware_spi.hpp) is
+// much faster, but needs the cs pin to move from B4 to B2.
+// The digits of each max7219 drive the columns of its matrix. For modules that
+// drive rows instead, use row_wiring (matrix_display.hpp).
 using csk_type = PIN_TYPE( B, 4);
 using spi_type = bitbanged_spi< spi_pins>;
 constexpr uint8_t matrix_count = 9;
-using display_type = max7219::display_buffer<matrix_count, spi_type, csk_type>;
+using display_type = matrix_display<matrix_count, spi_type, csk_type, column_wiring>;
 display_type display;
 
 
+/// Period, in timer ticks, of a display frame and of most animations.
+constexpr uint16_t frame_ticks = Timer::ticksPerSecond/50;
+
+/**
+ * Work that an MQTT handler leaves for the main loop.
+ *
+ * Handlers run from inside the receive poll, so anything that takes
+ * real time, like rendering or talking to the display, is queued as a
+ * command and executed at the next frame boundary.
+ */
+struct command
+{
+    enum Type : uint8_t
+    {
+        ShowText,
+        ShowFrame,
+        Flash,
+        Brightness
+    };
+
+    /**
+     * Return whether this command makes the other command obsolete.
+     * Text and frames both replace whatever the display shows.
+     */
+    bool replaces( const command &other) const
+    {
+        return type == other.type or (type <= ShowFrame and other.type <= ShowFrame);
+    }
+
+    Type    type;
+    uint8_t value;
+};
+
+/**
+ * Fixed-size fifo of commands.
+ *
+ * A pushed command replaces a queued command that it makes obsolete, so
+ * a burst of messages cannot fill the queue with work that would be
+ * overwritten anyway.
+ */
+template< uint8_t size>
+class command_queue
+{
+public:
+    /**
+     * Add a command to the queue, or replace an obsolete one.
+     * Returns false if the queue is full.
+     */
+    bool push( const command &new_command)
+    {
+        for (uint8_t index = 0; index < m_count; ++index)
+        {
+            auto &queued = at( index);
+            if (new_command.replaces( queued))
+            {
+                queued = new_command;
+                return true;
+            }
+        }
+
+        if (m_count == size) return false;
+        at( m_count++) = new_command;
+        return true;
+    }
+
+    bool pop( command &result)
+    {
+        if (not m_count) return false;
+        result = m_commands[m_first];
+        m_first = (m_first + 1) % size;
+        --m_count;
+        return true;
+    }
+
+    uint8_t count() const
+    {
+        return m_count;
+    }
+
+private:
+    command &at( uint8_t index)
+    {
+        return m_commands[(m_first + index) % size];
+    }
+
+    command m_commands[size];
+    uint8_t m_first = 0;
+    uint8_t m_count = 0;
+};
+
+/**
+ * Run time settings of the fireworks, changed through the fireworks/... topics.
+ */
+struct fireworks_settings
+{
+    static constexpr uint8_t max_rockets = 5;
+    static constexpr uint8_t max_trail = 3;
+    static constexpr uint8_t max_burst = 8;
+    static constexpr int8_t  max_gravity = 4;
+
+    uint8_t rocket_count = 5;
+    uint8_t trail_length = 3;
+    uint8_t burst_size = 8;
+    int8_t  gravity = 1;
+};
+
 /**
  * Global state that describes the behaviour of this device.
  */
@@ -70,42 +188,107 @@ struct global_state_type
 {
     PIN_TYPE( B, 1) ws2811_signal;
     ws2811::rgb leds[led_count] = {{ 128, 0,0}, {0, 128, 0}, {0, 128, 0}};
-    flare flares[flare_count];
+    flare_pool<flare_count, led_count> flares;
+    led_timeline<keyframe_count> timeline;
     bool leds_changed = false;
+    bool display_changed = false;
     uint8_t flashSpeed   = 25;
-    uint8_t flashCounter = 0;
+    Timer::Periodic flash_task;
     bool    displayIsOn = true;
-    char    text_buffer[256] = {0};
-    int16_t text_offset = 0;
 
     void set_speed( uint8_t speed)
     {
         if (speed > wait_threshold) speed = wait_threshold;
         wait_step = speed;
+        if (do_scroll)
+        {
+            start_scroll();
+        }
+    }
+
+    /**
+     * (Re)start scrolling. The text moves one column every
+     * wait_threshold / wait_step frames.
+     */
+    void start_scroll()
+    {
+        scroll_task.Start( wait_step ? frame_ticks * wait_threshold / wait_step : 0);
     }
 
     // determine globally the speed of all animations
     bool do_scroll = false;
     uint8_t  wait_step = 48;
-    uint8_t  wait_accumulator = 0;
     static constexpr uint8_t wait_threshold = 128;
+    Timer::Periodic scroll_task{ 0, Timer::Periodic::CatchUp};
 
+    // the tasks of the effects are only polled while the effect is active,
+    // so they are restarted when the effect starts.
     bool do_snowflakes = false;
     bool snowflakes_active = false;
+    Timer::Periodic snow_task;
     bool do_droplets = false;
 
     bool do_fireworks = false;
     bool fireworks_active = false;
+    Timer::Periodic fireworks_task;
+    fireworks_settings fireworks;
+
+    // flow control: an acknowledgement is published after every
+    // ack_interval messages, if ack_interval is not zero.
+    uint16_t sequence = 0;
+    uint8_t  ack_interval = 0;
+    uint8_t  unacknowledged = 0;
+    bool     ack_pending = false;
+
+    command_queue<4> commands;
+
+    /// A ShowText or ShowFrame command is queued. The text column cache already
+    /// holds its new contents, so the display must not scroll or render until the
+    /// command has run.
+    bool show_pending = false;
+
+    /// maximum amount of queued commands to execute per frame
+    static constexpr uint8_t commands_per_frame = 1;
+
+    /**
+     * Amount of messages that a producer may send beyond the last
+     * acknowledged one.
+     */
+    uint16_t credits() const
+    {
+        // one batch of messages can be underway while the
+        // previous one is being acknowledged, minus the work that
+        // is still waiting in the command queue.
+        const uint16_t window = 2 * ack_interval;
+        return window > commands.count() ? window - commands.count() : 0;
+    }
+
+    /**
+     * Register a processed message and determine whether it
+     * needs to be acknowledged.
+     */
+    void count_message()
+    {
+        ++sequence;
+        if (ack_interval and ++unacknowledged >= ack_interval)
+        {
+            unacknowledged = 0;
+            ack_pending = true;
+        }
+    }
 } g;
 
 // communication with esp-link
-esp_link::client::uart_type uart{4800};
+constexpr uint16_t uart_baud_rate = 4800;
+esp_link::client::uart_type uart{ uart_baud_rate};
 IMPLEMENT_UART_INTERRUPT( uart);
 esp_link::client esp{ uart};
 
 PIN_TYPE( B, 6) led;
 
 
+glyph_index glyphs;
+
 /**
  * Object to translate an ascii string into bits to be rendered
  * on the matrix display.
@@ -149,6 +332,28 @@ public:
         return (not next_column and not *next_character);
     }
 
+    /**
+     * Skip the given amount of columns.
+     *
+     * Characters that fall completely within the skipped columns are
+     * skipped as a whole, without visiting their columns.
+     */
+    void skip( uint16_t count)
+    {
+        while (not next_column and *next_character)
+        {
+            const uint8_t columns = glyphs.columns( *next_character);
+            if (columns > count) break;
+            count -= columns;
+            ++next_character;
+        }
+
+        for (; count; --count)
+        {
+            next();
+        }
+    }
+
 private:
     bool fetch_next_character()
     {
@@ -164,7 +369,7 @@ private:
         {
             // find a null terminated range of column bytes in pgm memory
             // that describe the characters shape.
-            next_column = font5x8::find_character( character);
+            next_column = glyphs.find( character);
         }
         return true;
     }
@@ -180,33 +385,38 @@ private:
  * empty columns or, if offset is negative, to the left by not rendering
  * the first columns of the text.
  *
- * This function returns the number of columns it tried to render, which
- * could be more than the actual amount of columns on the display.
+ * Rendering stops after 'limit' columns, which by default is the width
+ * of the display. Columns to the right of the display are never visited, so
+ * the cost of this function does not depend on the length of the string.
  *
+ * This function returns the number of columns it rendered. The full width
+ * of a text is available from column_cache::width().
  */
-uint16_t render_string( const char *str, int16_t offset = 0)
+uint16_t render_string(
+        const char *str,
+        int16_t offset = 0,
+        uint16_t limit = display_type::column_count)
 {
     uint16_t columns = 0;
     string_bits bits{ str};
 
     // "render" columns to the left of the physical display
-    while (offset < 0)
+    if (offset < 0)
     {
-        ++offset;
-        bits.next();
+        bits.skip( -offset);
+        offset = 0;
     }
 
     // render empty columns to move the text to the right
-    while (offset > 0)
+    while (offset > 0 and columns < limit)
     {
         display.push_column(0);
         ++columns;
         --offset;
     }
 
-    // render columns, potentially
-    // rendering more than fit on the display.
-    while (not bits.at_end())
+    // render columns up to the edge of the display.
+    while (not bits.at_end() and columns < limit)
     {
         display.push_column( bits.next());
         ++columns;
@@ -215,6 +425,257 @@ uint16_t render_string( const char *str, int16_t offset = 0)
     return columns;
 }
 
+/**
+ * RAM copy of the pixel columns of a text.
+ *
+ * Translating a string to columns means looking up every character in the
+ * font tables in program memory. A scrolling text would have to do that
+ * for every frame, for every character up to and including the visible ones.
+ * This class rasterizes a string once, after which every frame is just a copy
+ * of the visible columns.
+ *
+ * The text itself is kept at the end of the same buffer and the columns
+ * are rasterized into the space in front of it, so that the device does not
+ * need a separate text buffer. Texts whose columns do not fit in front of the
+ * text are only measured, not stored. For those texts is_valid() returns
+ * false and the caller must fall back to rendering the string itself.
+ *
+ * Instead of a text, the cache can also hold raw columns, written with write().
+ * Writing columns discards the text.
+ */
+template< uint16_t size>
+class column_cache
+{
+public:
+    /// Longest text that can be stored, in characters.
+    static constexpr uint16_t max_text_length = size - 1;
+
+    /**
+     * Store a text of at most len characters at the end of the cache. The text
+     * also ends at the first zero character.
+     *
+     * This discards the columns that were in the cache until rasterize() is
+     * called.
+     */
+    void store( const char *text, uint16_t len)
+    {
+        uint16_t length = 0;
+        while (length < len and length < max_text_length and text[length])
+        {
+            ++length;
+        }
+
+        m_width = 0;
+        m_text = size - length - 1;
+        memcpy( m_columns + m_text, text, length);
+        m_columns[size - 1] = 0;
+    }
+
+    /**
+     * Rasterize the stored text into the cache and determine its width
+     * in columns.
+     */
+    void rasterize()
+    {
+        string_bits bits{ text()};
+        m_width = 0;
+        while (not bits.at_end())
+        {
+            const auto column = bits.next();
+
+            // columns in front of the text never overwrite characters
+            // that still need to be read.
+            if (m_width < m_text)
+            {
+                m_columns[m_width] = column;
+            }
+            ++m_width;
+        }
+    }
+
+    /**
+     * Overwrite the columns starting at 'first' with raw column bytes.
+     *
+     * If the new columns extend beyond the current width, the width grows and
+     * columns between the old width and 'first' become empty. Columns that do
+     * not fit in the cache are ignored. If the cache held a text that did not
+     * fit, it is treated as empty.
+     */
+    void write( uint16_t first, const char *columns, uint16_t count)
+    {
+        if (not is_valid())
+        {
+            m_width = 0;
+        }
+        m_text = size;
+        for (; m_width < first and m_width < size; ++m_width)
+        {
+            m_columns[m_width] = 0;
+        }
+        for (; count and first < size; --count)
+        {
+            m_columns[first++] = *columns++;
+        }
+        if (first > m_width)
+        {
+            m_width = first;
+        }
+    }
+
+    void clear()
+    {
+        m_width = 0;
+        m_text = size;
+    }
+
+    /**
+     * Return whether all columns of the last rasterized string
+     * fit in the cache.
+     */
+    bool is_valid() const
+    {
+        return m_width <= m_text;
+    }
+
+    /**
+     * The stored text, or an empty string if the cache holds raw columns.
+     */
+    const char *text() const
+    {
+        return m_text < size ? reinterpret_cast<const char *>( m_columns + m_text) : "";
+    }
+
+    /**
+     * Width, in columns, of the last rasterized string. This is
+     * also valid if the string did not fit in the cache.
+     */
+    uint16_t width() const
+    {
+        return m_width;
+    }
+
+    /**
+     * Return a single column of the cached text.
+     */
+    uint8_t column( uint16_t index) const
+    {
+        return m_columns[index];
+    }
+
+    /**
+     * Copy the cached text to the display, starting at its left edge.
+     */
+    template< typename display_type>
+    void render( display_type &display) const
+    {
+        for (uint16_t column = 0; column < display_type::column_count; ++column)
+        {
+            display.push_column( column < m_width ? m_columns[column] : 0);
+        }
+    }
+
+private:
+    uint16_t m_width = 0;
+    uint16_t m_text = size;     ///< index of the first character of the text
+    uint8_t  m_columns[size];
+};
+
+/// Amount of empty columns between the end of a scrolling text and
+/// the start of its repetition.
+constexpr uint8_t repeat_space = 6;
+
+/// Most texts are short enough to be scrolled from RAM, longer texts are
+/// scrolled from the font tables directly. The cache also holds the text.
+constexpr uint16_t text_cache_size = 256;
+column_cache<text_cache_size> text_columns;
+
+/**
+ * Scrolls a text across the display, one column per step.
+ *
+ * The scroller keeps its position in the text, including the empty columns
+ * between the end of the text and its repetition. Every frame copies the
+ * visible columns from the column cache. If the text did not fit in the cache,
+ * the columns are rendered from the text that the cache stores. For that case the
+ * scroller also keeps a string_bits that points at the column at the left edge of
+ * the display, which moves along with every step, so that a frame never has to
+ * skip the columns to the left of the display.
+ */
+template< typename cache_type>
+class text_scroller
+{
+public:
+    /**
+     * Start scrolling the contents of the cache, with 'gap' empty columns
+     * between the end of the text and the start of the repeated text.
+     *
+     * The cache must contain the rasterized text. If the text did not fit
+     * in the cache, the columns are taken from the string instead.
+     */
+    void start( const cache_type &cache, uint8_t gap)
+    {
+        m_cache = &cache;
+        m_position = 0;
+        m_period = cache.width() + gap;
+        m_bits = string_bits{ cache.text()};
+    }
+
+    /**
+     * Move the text one column to the left.
+     */
+    void step()
+    {
+        if (++m_position >= m_period)
+        {
+            m_position = 0;
+            m_bits = string_bits{ m_cache->text()};
+        }
+        else if (m_position <= m_cache->width() and not m_cache->is_valid())
+        {
+            m_bits.next();
+        }
+    }
+
+    template< typename display_type>
+    void render( display_type &display) const
+    {
+        const uint16_t width = m_cache->width();
+        uint16_t position = m_position;
+        for (uint16_t column = 0; column < display_type::column_count;)
+        {
+            if (position >= width)
+            {
+                // the gap before the text repeats.
+                display.push_column( 0);
+                ++column;
+                if (++position >= m_period) position = 0;
+            }
+            else if (m_cache->is_valid())
+            {
+                display.push_column( m_cache->column( position++));
+                ++column;
+            }
+            else
+            {
+                // the left edge continues from the scroller, a repetition
+                // starts at the beginning of the text.
+                string_bits bits = position == m_position ? m_bits : string_bits{ m_cache->text()};
+                for (; column < display_type::column_count and position < width; ++column, ++position)
+                {
+                    display.push_column( bits.next());
+                }
+            }
+        }
+    }
+
+private:
+    const cache_type *m_cache = nullptr;
+    uint16_t          m_position = 0;
+    uint16_t          m_period = 0;
+    string_bits       m_bits{ ""};  ///< the column at m_position, for uncached texts
+};
+
+text_scroller< decltype( text_columns)> scroller;
+
 char *my_strcpy( char *dest, const char *src, uint16_t len)
 {
     while (len && *src)
@@ -238,14 +699,73 @@ char *my_strcpy( char (&dest)[buffer_size], const char *src, uint16_t len)
 
 uint16_t parse_uint16( esp_link::string_ref &string)
 {
-    return text_parsing::parse_uint16( string.buffer, string.buffer + string.len);
+    const char *end = string.buffer + string.len;
+    const auto result = text_parsing::parse_uint16( string.buffer, end);
+    string.len = end - string.buffer;
+    return result;
 }
 
 bool consume( esp_link::string_ref &string, const char *expectation)
 {
-    return text_parsing::consume( string.buffer, string.buffer + string.len, expectation);
+    const char *end = string.buffer + string.len;
+    const auto result = text_parsing::consume( string.buffer, end, expectation);
+    string.len = end - string.buffer;
+    return result;
+}
+
+/**
+ * Hash of a topic name, up to the first '/' or the end of the name.
+ *
+ * Topics are dispatched with a switch on this hash. The compiler rejects
+ * duplicate case labels, so two topic names that have the same hash
+ * are caught at compile time.
+ */
+constexpr uint16_t topic_hash( const char *name, uint16_t hash = 5381)
+{
+    return (*name == 0 or *name == '/') ?
+            hash : topic_hash( name + 1, (hash * 33) ^ static_cast<uint8_t>( *name));
+}
+
+/**
+ * Consume the next word of a topic, including the '/' that may follow it,
+ * and return its topic_hash(). The word itself, without the '/', is
+ * returned in 'word'.
+ */
+uint16_t consume_topic_word( esp_link::string_ref &topic, esp_link::string_ref &word)
+{
+    uint16_t hash = topic_hash( "");
+    word.buffer = topic.buffer;
+    while (topic.len and *topic.buffer != '/')
+    {
+        hash = (hash * 33) ^ static_cast<uint8_t>( *topic.buffer++);
+        --topic.len;
+    }
+    word.len = topic.buffer - word.buffer;
+    if (topic.len)
+    {
+        ++topic.buffer;
+        --topic.len;
+    }
+    return hash;
 }
 
+/**
+ * Return true if a topic word is equal to a name in program memory.
+ */
+bool is_topic_word( const esp_link::string_ref &word, const char *name)
+{
+    return strlen_P( name) == word.len and strncmp_P( word.buffer, name, word.len) == 0;
+}
+
+/**
+ * Case label for a topic name in a switch on consume_topic_word().
+ *
+ * Different words can have the same hash, so the case also compares the word
+ * with the name and leaves the switch if they differ, as if the word were unknown.
+ */
+#define TOPIC_CASE( word, name) \
+    case topic_hash( name): if (not is_topic_word( word, PSTR( name))) break
+
 
 uint8_t to_decimal( char hex_digit)
 {
@@ -257,18 +777,29 @@ uint8_t to_decimal( char hex_digit)
     return 0;
 }
 
-ws2811::rgb parse_rgb_hex(  const char *(&input), const char *end)
+/**
+ * Consume up to two hexadecimal digits from the string and return their value.
+ */
+uint8_t parse_hex_byte( esp_link::string_ref &string)
 {
-    ws2811::rgb result{0,0,0};
-
-    if (input != end) result.red   = to_decimal( *input++);
-    if (input != end) result.red   = result.red * 16 + to_decimal( *input++);
+    uint8_t result = 0;
+    for (uint8_t digit = 0; digit < 2 and string.len; ++digit, --string.len)
+    {
+        result = result * 16 + to_decimal( *string.buffer++);
+    }
+    return result;
+}
 
-    if (input != end) result.green = to_decimal( *input++);
-    if (input != end) result.green = result.green * 16 + to_decimal( *input++);
+/**
+ * Consume a color as six hexadecimal digits. Missing digits count as zero.
+ */
+ws2811::rgb parse_rgb_hex( esp_link::string_ref &string)
+{
+    ws2811::rgb result{0,0,0};
 
-    if (input != end) result.blue   = to_decimal( *input++);
-    if (input != end) result.blue   = result.blue * 16 + to_decimal( *input++);
+    result.red   = parse_hex_byte( string);
+    result.green = parse_hex_byte( string);
+    result.blue  = parse_hex_byte( string);
 
     return result;
 }
@@ -279,70 +810,255 @@ ws2811::rgb parse_rgb( esp_link::string_ref &string)
 
     if (consume( string, "#"))
     {
-        result = parse_rgb_hex( string.buffer, string.buffer + string.len);
+        result = parse_rgb_hex( string);
+    }
+    else
+    {
+
+        result.red = parse_uint16( string);
+        consume( string, ",");
+        result.green = parse_uint16( string);
+        consume( string, ",");
+        result.blue = parse_uint16( string);
+    }
+
+    return result;
+}
+
+/**
+ * Set the colors of a range of leds, starting at led 'first', from a single message.
+ *
+ * The message contains the colors as raw bytes, three bytes per led. Colors
+ * beyond the last led are ignored.
+ */
+template<size_t led_count>
+void set_leds( ws2811::rgb (&leds)[led_count], uint8_t first, esp_link::string_ref &message)
+{
+    const char *end = message.buffer + message.len;
+    while (first < led_count and end - message.buffer >= 3)
+    {
+        auto &led = leds[first++];
+        led.red   = *message.buffer++;
+        led.green = *message.buffer++;
+        led.blue  = *message.buffer++;
+    }
+}
+
+/**
+ * Set the colors of a range of leds, starting at led 'first', from a message
+ * that contains the colors as consecutive six-digit hexadecimal numbers.
+ * Colors beyond the last led are ignored.
+ */
+template<size_t led_count>
+void set_leds_hex( ws2811::rgb (&leds)[led_count], uint8_t first, esp_link::string_ref &message)
+{
+    while (first < led_count and message.len)
+    {
+        leds[first++] = parse_rgb_hex( message);
+    }
+}
+
+/**
+ * Overwrite ranges of columns of the frame in the cache.
+ *
+ * The message consists of one or more ranges. Each range is a byte with the
+ * index of the first column, a byte with the amount of columns, followed by
+ * the column bytes themselves.
+ */
+template< typename cache_type>
+void write_frame_ranges( cache_type &cache, const esp_link::string_ref &message)
+{
+    const char *current = message.buffer;
+    const char *end = message.buffer + message.len;
+    while (end - current >= 2)
+    {
+        const uint8_t first = *current++;
+        uint8_t count = *current++;
+        if (count > end - current)
+        {
+            count = end - current;
+        }
+        cache.write( first, current, count);
+        current += count;
+    }
+}
+
+template<size_t led_count, typename flares_type>
+void clear_leds( ws2811::rgb (&leds)[led_count], flares_type &flares)
+{
+    flares.stop_all();
+
+    for (auto &currentLed : leds)
+    {
+        currentLed = {0,0,0};
+    }
+
+}
+
+
+
+/**
+ * Start showing the contents of the text column cache,
+ * scrolling if it does not fit the display.
+ */
+void start_text()
+{
+    g.do_scroll = text_columns.width() > display_type::column_count;
+    if (g.do_scroll)
+    {
+        scroller.start( text_columns, repeat_space);
+        g.start_scroll();
     }
     else
     {
-
-        result.red = parse_uint16( string);
-        consume( string, ",");
-        result.green = parse_uint16( string);
-        consume( string, ",");
-        result.blue = parse_uint16( string);
+        g.scroll_task.Stop();
     }
-
-    return result;
+    g.display_changed = true;
 }
 
 /**
- * return the index of an inactive flare, if any.
- * otherwise will return count.
- *
- * WATCH OUT: the returned index cannot be used
- * without testing for it being 'count' first.
+ * Show the frame in the text column cache instead of the text. Frames that are
+ * wider than the display scroll, just like text.
  */
-template<size_t count>
-uint8_t find_idle_flare( flare (&flares)[count], uint8_t led_index)
+void show_frame()
 {
+    start_text();
+}
 
+void show_text()
+{
+    text_columns.rasterize();
+    start_text();
+}
 
-    // first try to find a flare that is already animating this led
-    for (uint8_t index = 0; index < count; ++index)
+void execute( const command &c)
+{
+    switch (c.type)
     {
-        if (flares[index].led_index() == led_index)
+    case command::ShowText:
+        g.show_pending = false;
+        show_text();
+        break;
+
+    case command::ShowFrame:
+        g.show_pending = false;
+        show_frame();
+        break;
+
+    case command::Flash:
+        if (c.value)
         {
-            return index;
+            g.flash_task.Start( g.flashSpeed * frame_ticks);
         }
-    }
-
-    // then try to find one that is idle
-    for (uint8_t index = 0; index < count; ++index)
-    {
-        if (not flares[index].is_active())
+        else
         {
-            return index;
+            display.enable( true);
+            g.displayIsOn = true;
+            g.flash_task.Stop();
         }
-    }
+        break;
 
-    return count;
+    case command::Brightness:
+        display.brightness( c.value);
+        break;
+    }
 }
 
-template<size_t led_count, size_t flare_count>
-void clear_leds( ws2811::rgb (&leds)[led_count], flare (&flares)[flare_count])
+/**
+ * Queue a command for the main loop. If the queue is full, the command is
+ * executed right away.
+ */
+void defer( const command &c)
 {
-    for (auto &flare: flares)
+    if (not g.commands.push( c))
     {
-        flare.stop();
+        execute( c);
     }
-
-    for (auto &currentLed : leds)
+    else if (c.type <= command::ShowFrame)
     {
-        currentLed = {0,0,0};
+        g.show_pending = true;
     }
-
 }
 
+/**
+ * Load a timeline of led keyframes from a message and start playing it.
+ *
+ * The message has the form "loop;keyframe;keyframe;...", where loop is 0 to play
+ * the timeline once or 1 to repeat it, and each keyframe has the form
+ * "[+]first,last,color,duration[,curve]":
+ *   - a leading '+' starts the keyframe at the same time as the previous one,
+ *   - first and last are the inclusive range of leds,
+ *   - color is the target color, as "#rrggbb" or "r,g,b",
+ *   - duration is the amount of led frames (20ms) of the fade,
+ *   - curve is the easing curve of the fade, as for flares.
+ * A message without keyframes stops the timeline. Keyframes that do not fit
+ * in the timeline are ignored.
+ */
+template< typename timeline_type>
+void load_timeline( timeline_type &timeline, esp_link::string_ref &message)
+{
+    timeline.clear();
+    const bool loop = parse_uint16( message) != 0;
+    while (consume( message, ";"))
+    {
+        led_keyframe key;
+        key.with_previous = consume( message, "+");
+        key.first = parse_uint16( message);
+        consume( message, ",");
+        key.last = parse_uint16( message);
+        consume( message, ",");
+        key.to = parse_rgb( message);
+        consume( message, ",");
+        key.duration = parse_uint16( message);
+
+        uint8_t curve = easing::Linear;
+        if (consume( message, ","))
+        {
+            curve = parse_uint16( message);
+        }
+        if (curve >= easing::CurveCount)
+        {
+            curve = easing::Linear;
+        }
+        key.curve = curve;
+
+        if (not timeline.add( key)) break;
+    }
+    timeline.start( loop);
+}
 
+/**
+ * Change one of the fireworks settings. The topic names the setting:
+ * rockets, trail, burst or gravity. Values are limited to what
+ * the fireworks have room for.
+ */
+void configure_fireworks(
+        fireworks_settings &settings,
+        esp_link::string_ref &topic,
+        esp_link::string_ref &message)
+{
+    const uint16_t value = parse_uint16( message);
+    esp_link::string_ref word;
+    switch (consume_topic_word( topic, word))
+    {
+    TOPIC_CASE( word, "rockets");
+        settings.rocket_count = min( value, fireworks_settings::max_rockets);
+        break;
+
+    TOPIC_CASE( word, "trail");
+        settings.trail_length = min( value, fireworks_settings::max_trail);
+        break;
+
+    TOPIC_CASE( word, "burst");
+        settings.burst_size = min( value, fireworks_settings::max_burst);
+        break;
+
+    TOPIC_CASE( word, "gravity");
+        // without gravity, rockets would never burst
+        settings.gravity = value ? min<uint16_t>( value, fireworks_settings::max_gravity) : 1;
+        break;
+    }
+}
 
 /**
  * This function is called when an update is received on the subscribed MQTT topic.
@@ -364,64 +1080,85 @@ void update( const esp_link::packet *p, uint16_t size)
     // if the topic is indeed the expected one...
     if (consume(topic, MQTT_BASE_NAME))
     {
-        if (consume( topic, "text"))
-        {
-            display.clear();
-            my_strcpy( g.text_buffer, message.buffer, message.len);
-            g.do_scroll = render_string( g.text_buffer) > display_type::column_count;
-            g.wait_accumulator = 0;
-            if (not g.do_scroll)
-            {
-                display.transmit();
-                g.text_offset = 0;
-            }
-        }
-        else if (consume( topic, "flash"))
+        string_ref word;
+        switch (consume_topic_word( topic, word))
         {
-            if (consume( topic, "Speed"))
-            {
-                g.flashSpeed = parse_uint16( message);
-            }
-            else
+        // this device receives what it publishes itself, but
+        // those messages must not be acknowledged.
+        TOPIC_CASE( word, "version");
+            return;
+
+        TOPIC_CASE( word, "ack");
+            return;
+
+        TOPIC_CASE( word, "stats");
+            return;
+
+        TOPIC_CASE( word, "ackInterval");
+            g.ack_interval = parse_uint16( message);
+            g.unacknowledged = 0;
+            return;
+
+        TOPIC_CASE( word, "text");
+            text_columns.store( message.buffer, message.len);
+            defer( { command::ShowText, 0});
+            break;
+
+        TOPIC_CASE( word, "frame");
+            text_columns.clear();
+            text_columns.write( 0, message.buffer, message.len);
+            defer( { command::ShowFrame, 0});
+            break;
+
+        TOPIC_CASE( word, "frameDelta");
+            write_frame_ranges( text_columns, message);
+            defer( { command::ShowFrame, 0});
+            break;
+
+        TOPIC_CASE( word, "flash");
+            defer( { command::Flash, static_cast<uint8_t>( parse_uint16( message) != 0)});
+            break;
+
+        TOPIC_CASE( word, "flashSpeed");
+            g.flashSpeed = parse_uint16( message);
+            if (g.flash_task.IsRunning())
             {
-                uint8_t value = parse_uint16( message);
-                if (value)
-                {
-                    g.flashCounter = g.flashSpeed;
-                }
-                else
-                {
-                    display.enable( true);
-                    g.displayIsOn = true;
-                    g.flashCounter = 0;
-                }
+                g.flash_task.Start( g.flashSpeed * frame_ticks);
             }
-        }
-        else if (consume( topic, "scrollSpeed"))
-        {
+            break;
+
+        TOPIC_CASE( word, "scrollSpeed");
             g.set_speed( parse_uint16( message));
-        }
-        else if (consume( topic, "snow"))
-        {
+            break;
+
+        TOPIC_CASE( word, "snow");
             g.do_snowflakes = parse_uint16( message) != 0;
-            if (g.do_snowflakes)
+            if (g.do_snowflakes and not g.snowflakes_active)
             {
                 g.snowflakes_active = true;
+                g.snow_task.Start( frame_ticks);
+            }
+            break;
+
+        TOPIC_CASE( word, "fireworks");
+            if (topic.len)
+            {
+                configure_fireworks( g.fireworks, topic, message);
+                break;
             }
-        }
-        else if (consume( topic, "fireworks"))
-        {
             g.do_fireworks = parse_uint16( message) != 0;
-            if (g.do_fireworks)
+            if (g.do_fireworks and not g.fireworks_active)
             {
                 g.fireworks_active = true;
+                g.fireworks_task.Start( frame_ticks);
             }
-        }
-        else if (consume( topic, "brightness"))
-        {
-            display.brightness( parse_uint16( message));
-        }
-        else if (consume( topic, "led/"))
+            break;
+
+        TOPIC_CASE( word, "brightness");
+            defer( { command::Brightness, static_cast<uint8_t>( parse_uint16( message))});
+            break;
+
+        TOPIC_CASE( word, "led");
         {
             uint8_t led_index = parse_uint16( topic);
             if ( led_index < led_count)
@@ -429,17 +1166,34 @@ void update( const esp_link::packet *p, uint16_t size)
                 g.leds[led_index] = parse_rgb(message);
                 g.leds_changed = true;
             }
+            break;
         }
-        else if (consume( topic, "ledsOff"))
-        {
+
+        TOPIC_CASE( word, "ledsOff");
             if (parse_uint16(message))
             {
+                g.timeline.stop();
                 clear_leds( g.leds, g.flares);
             }
             g.leds_changed = true;
-        }
-        else if (consume( topic, "drops"))
-        {
+            break;
+
+        TOPIC_CASE( word, "leds");
+            // the index of the first led is optional and defaults to 0.
+            set_leds( g.leds, parse_uint16( topic), message);
+            g.leds_changed = true;
+            break;
+
+        TOPIC_CASE( word, "ledsHex");
+            set_leds_hex( g.leds, parse_uint16( topic), message);
+            g.leds_changed = true;
+            break;
+
+        TOPIC_CASE( word, "timeline");
+            load_timeline( g.timeline, message);
+            break;
+
+        TOPIC_CASE( word, "drops");
             if (parse_uint16(message))
             {
                 g.do_droplets = true;
@@ -450,8 +1204,9 @@ void update( const esp_link::packet *p, uint16_t size)
                 g.leds_changed = true;
                 clear(g.leds);
             }
-        }
-        else if (consume( topic, "flare/"))
+            break;
+
+        TOPIC_CASE( word, "flare");
         {
             uint8_t flare_index = 0;
             bool do_find_idle_flare = false;
@@ -473,6 +1228,7 @@ void update( const esp_link::packet *p, uint16_t size)
                 ws2811::rgb to{32,32,32};
                 uint8_t speed = 64;
                 uint8_t mode = 0;
+                uint8_t curve = easing::Linear;
 
                 led_index = parse_uint16( message);
                 if (led_index >= led_count)
@@ -481,7 +1237,8 @@ void update( const esp_link::packet *p, uint16_t size)
                 }
                 if (do_find_idle_flare)
                 {
-                    flare_index = find_idle_flare( g.flares, led_index);
+                    // may be none, if all flares are busy.
+                    flare_index = g.flares.find( led_index);
                 }
                 if (consume(message, ","))
                 {
@@ -502,6 +1259,10 @@ void update( const esp_link::packet *p, uint16_t size)
                             if (consume( message, ","))
                             {
                                 speed = parse_uint16( message);
+                                if (consume( message, ","))
+                                {
+                                    curve = parse_uint16( message);
+                                }
                             }
                         }
                     }
@@ -511,125 +1272,178 @@ void update( const esp_link::packet *p, uint16_t size)
                 {
                     mode = flare::OneShot;
                 }
-                g.flares[flare_index].setup( led_index, static_cast<flare::Mode>( mode), from, to, speed);
+                if (curve >= easing::CurveCount)
+                {
+                    curve = easing::Linear;
+                }
+                g.flares.start(
+                        flare_index, led_index, static_cast<flare::Mode>( mode), from, to, speed,
+                        static_cast<easing::Curve>( curve));
             }
+            break;
+        }
 
+        default:
+            break;
         }
-    }
-}
 
-void connected( const esp_link::packet *p, uint16_t size)
-{
-    set(led);
-    using esp_link::mqtt::subscribe;
-    using esp_link::mqtt::publish;
-    //esp.send("connected\n");
-    esp.execute( subscribe, MQTT_BASE_NAME "#", 0);
-    esp.execute( publish, MQTT_BASE_NAME "version", "0.2", 0, false);
-    clear(led);
+        g.count_message();
+    }
 }
 
-// fireworks related classes
-
 /**
- * This class represents a dot rendered on a matrix display.
- *
- * Each dot has an x,y-position where x and y have a higher resolution
- * than the actual dots on the matrix.
- *
- * A dot can be "at_end", which means that the dot will not be
- * displayed.
+ * Write the decimal representation of value to the buffer and return a
+ * pointer just past the last digit. The result is not null-terminated.
  */
-class dot
+char *format_uint16( char *buffer, uint16_t value)
 {
-public:
-
-    dot()
-    :x{0}, y{y_end}
+    char digits[5];
+    uint8_t count = 0;
+    do
     {
-    }
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
 
-    dot( int16_t x, uint8_t y)
-    :x{x},y{y}
+    while (count)
     {
+        *buffer++ = digits[--count];
     }
+    return buffer;
+}
 
-    void render( display_type &display) const
-    {
-        if (
-            not at_end() and
-            x >= 0 and x < 8*x_scale*matrix_count and
-            y >= 0)
-        {
-            display.set_pixel( x / x_scale, y / y_scale);
-        }
-    }
+/**
+ * Publish an acknowledgement as "<sequence>,<credits>", where sequence counts the
+ * messages that have been processed so far and credits is the amount of
+ * messages that may be sent beyond that.
+ */
+void publish_ack()
+{
+    using esp_link::mqtt::publish;
 
-    bool at_end() const
-    {
-        return y >= y_end;
-    }
+    char buffer[12];
+    char *end = format_uint16( buffer, g.sequence);
+    *end++ = ',';
+    end = format_uint16( end, g.credits());
+    *end = 0;
 
+    esp.execute( publish, MQTT_BASE_NAME "ack", buffer, 0, false);
+    g.ack_pending = false;
+}
 
-    static constexpr uint8_t x_scale = 16;
-    static constexpr uint8_t y_scale = 16;
-    static constexpr uint8_t y_end = 8 * y_scale;
+using profiling::frame_profiler;
+frame_profiler profiler;
 
-    int16_t x; // in 12.4 fixed point
-    int16_t y;  // in12.4 fixed point
-};
+#ifdef WIFIMATRIX_PROFILE
+/// names of the profiler phases, in the order of profiling::Phase.
+const char phase_names[][10] PROGMEM = {
+        "recv", "step", "leds", "send", "flush", "text",
+        "snowStep", "snowDraw", "fireStep", "fireDraw"};
+static_assert( sizeof phase_names / sizeof phase_names[0] == profiling::PhaseCount, "a phase has no name");
 
 /**
- * a moving dot
+ * Publish the minimum, mean and maximum duration of one main loop phase since
+ * its previous publication, or, for phase PhaseCount, the number of missed frame
+ * deadlines. Each phase has its own message, to keep the buffer small.
  */
-class velocity_dot : public dot
+void publish_stats( uint8_t phase)
 {
-public:
-    velocity_dot()
-    :dot{},
-     vx{0},
-     vy{0}
-    {
-
-    }
+    using esp_link::mqtt::publish;
 
-    velocity_dot( int16_t x, uint8_t y, int16_t vx, int8_t vy)
-    :dot{x,y}, vx{vx}, vy{vy}
+    char buffer[sizeof phase_names[0] + 3 * 6];
+    char *end = buffer;
+    if (phase < profiling::PhaseCount)
     {
+        const auto &stats = profiler.stats( static_cast<profiling::Phase>( phase));
+        strcpy_P( end, phase_names[phase]);
+        end += strlen( end);
+        *end++ = '=';
+        end = format_uint16( end, stats.count ? stats.min : 0);
+        *end++ = ',';
+        end = format_uint16( end, stats.mean());
+        *end++ = ',';
+        end = format_uint16( end, stats.max);
+        profiler.reset( static_cast<profiling::Phase>( phase));
     }
-
-    void step(int8_t gravity)
+    else
     {
-        if (not at_end())
-        {
-            x += vx;
-            y += vy;
-            vy += gravity;
-        }
+        end = my_strcpy( end, "missed=", 7);
+        end = format_uint16( end, profiler.missed());
+        profiler.reset_missed();
     }
+    *end = 0;
 
+    esp.execute( publish, MQTT_BASE_NAME "stats", buffer, 0, false);
+}
+#endif
 
-    int16_t vx;
-    int8_t vy;
+void connected( const esp_link::packet *p, uint16_t size)
+{
+    set(led);
+    using esp_link::mqtt::subscribe;
+    using esp_link::mqtt::publish;
+    //esp.send("connected\n");
+    esp.execute( subscribe, MQTT_BASE_NAME "#", 0);
+    esp.execute( publish, MQTT_BASE_NAME "version", "0.2", 0, false);
+    clear(led);
+}
+
+// fireworks related classes
+
+/**
+ * Fixed point configuration of the sparks of fireworks. Sparks that leave the
+ * display horizontally keep falling, because the wind does not blow them back.
+ */
+struct spark_config
+{
+    static constexpr uint8_t fraction_bits = 4;
+    static constexpr int16_t x_end = display_type::column_count * 16;
+    static constexpr bool    clip_x = false;
+    static constexpr bool    has_vx = true;
+};
+
+/**
+ * Velocities of the sparks of a burst, relative to the rocket, at 16 equally
+ * spaced angles on an ellipse that is wider than it is high.
+ */
+const int8_t burst_velocities[][2] PROGMEM = {
+        { 9,  0}, { 8,  2}, { 6,  3}, { 3,  4},
+        { 0,  4}, {-3,  4}, {-6,  3}, {-8,  2},
+        {-9,  0}, {-8, -2}, {-6, -3}, {-3, -4},
+        { 0, -4}, { 3, -4}, { 6, -3}, { 8, -2},
 };
 
+constexpr uint8_t burst_directions = sizeof burst_velocities / sizeof burst_velocities[0];
+static_assert( fireworks_settings::max_burst <= burst_directions, "burst table too small");
+
+/**
+ * A rocket that waits for its fuse to burn, then rises with a short trail
+ * and bursts into sparks at the top of its flight.
+ *
+ * The trail is a ring buffer of previous positions: every step overwrites
+ * the oldest one. The sparks are added to a particle system that is shared
+ * by all rockets.
+ */
 class rocket
 {
 public:
     rocket()
-    :fuse{0}, trigger{127}
+    :x{0}, y{0}, vx{0}, vy{0}, fuse{0}, in_flight{false},
+     trail_length{0}, trail_size{0}, trail_next{0}
     {
     }
 
-    rocket(int16_t x, int16_t vx, int8_t vy, uint8_t fuse, int8_t trigger = 0)
-    :
-     fuse{fuse},
-     trigger{trigger}
+    rocket(int16_t x, int16_t vx, int8_t vy, uint8_t fuse, uint8_t trail_length)
+    :x{x}, y{127}, vx{vx}, vy{vy}, fuse{fuse}, in_flight{true},
+     trail_length{trail_length}, trail_size{0}, trail_next{0}
     {
-        dots[0] = {x, 127, vx, vy};
     }
 
-    bool step(int8_t gravity)
+    /**
+     * Move the rocket. Returns false after the rocket has burst.
+     */
+    template< typename sparks_type>
+    bool step( const fireworks_settings &settings, sparks_type &sparks)
     {
         // rocket on the ground, fuse burning
         if (fuse)
@@ -638,64 +1452,79 @@ public:
             return true;
         }
 
-        // in flight, before burst
-        if (not dots[0].at_end() and dots[0].vy < trigger)
-        {
-            // create a trail of at most 4 dots
-            for (uint8_t dot = min(dot_count, 4) - 1; dot > 0; --dot)
-            {
-                dots[dot] = dots[dot-1];
-            }
-
-            dots[0].step( gravity);
+        if (not in_flight) return false;
 
-            // do we burst now?
-            if (dots[0].vy >= trigger)
-            {
-                constexpr static int8_t v_offset = 6;
-                // make sure we are always in the burst state from here on
-                trigger = -128;
-                for (auto &dot : dots)
-                {
-                    dot.x = dots[0].x;
-                    dot.y = dots[0].y;
-                    dot.vx = dots[0].vx + plusminus( v_offset, v_offset);
-                    dot.vy = dots[0].vy + plusminus( 1, v_offset);
-                }
-            }
-            return true;
+        if (trail_length)
+        {
+            trail_x[trail_next] = x;
+            trail_y[trail_next] = y;
+            if (++trail_next == trail_length) trail_next = 0;
+            if (trail_size < trail_length) ++trail_size;
         }
 
-        // after burst
-        bool active_dot = false;
-        for ( auto &dot : dots)
+        x += vx;
+        y += vy;
+        vy += settings.gravity;
+
+        // do we burst now?
+        if (vy >= 0)
         {
-            if (!dot.at_end())
-            {
-                active_dot = true;
-                dot.step( gravity);
-            }
+            burst( settings.burst_size, sparks);
+            in_flight = false;
+            return false;
         }
 
-        return active_dot;
+        return true;
     }
 
+    template< typename display_type>
     void render( display_type &display) const
     {
-        if (not fuse)
+        if (in_flight and not fuse)
         {
-            for (const auto &dot: dots)
+            plot_particle<spark_config::fraction_bits>( display, x, y);
+            for (uint8_t index = 0; index < trail_size; ++index)
             {
-                dot.render( display);
+                plot_particle<spark_config::fraction_bits>( display, trail_x[index], trail_y[index]);
             }
         }
     }
 
 private:
-    static constexpr uint8_t dot_count = 8;
-    velocity_dot dots[dot_count];
+    /**
+     * Add spark_count sparks, spread evenly over the directions of the
+     * burst table, starting at a random direction.
+     */
+    template< typename sparks_type>
+    void burst( uint8_t spark_count, sparks_type &sparks) const
+    {
+        if (not spark_count) return;
+
+        // angles in units of 1/256th of a circle.
+        const uint8_t angle_step = 256 / spark_count;
+        uint8_t angle = my_rand();
+        for (uint8_t count = spark_count; count; --count)
+        {
+            const auto &velocity = burst_velocities[angle / (256 / burst_directions)];
+            sparks.add(
+                    x, y,
+                    vx + static_cast<int8_t>( pgm_read_byte( &velocity[0])),
+                    vy + static_cast<int8_t>( pgm_read_byte( &velocity[1])));
+            angle += angle_step;
+        }
+    }
+
+    int16_t x;  // in 12.4 fixed point
+    int16_t y;  // in 12.4 fixed point
+    int16_t vx;
+    int8_t  vy;
     uint8_t fuse;
-    int8_t trigger;
+    bool    in_flight;
+    uint8_t trail_length;
+    uint8_t trail_size;
+    uint8_t trail_next;
+    int16_t trail_x[fireworks_settings::max_trail];
+    int16_t trail_y[fireworks_settings::max_trail];
 };
 
 class rockets_type
@@ -703,53 +1532,73 @@ class rockets_type
 public:
     rockets_type()
     {
-        for (auto & rocket: rockets)
+        for (uint8_t index = 0; index < g.fireworks.rocket_count; ++index)
         {
-            rocket = random_rocket();
+            rockets[index] = random_rocket( g.fireworks);
         }
     }
 
-    bool render( display_type &display, bool make_new)
+    /**
+     * Move all rockets and sparks. If make_new is true, rockets that have
+     * burst are replaced by new ones, for as many rockets as the settings ask for.
+     *
+     * Returns false if no more rockets or sparks are active.
+     */
+    bool step( bool make_new, const fireworks_settings &settings)
     {
-        constexpr int8_t gravity = 1;
         bool active = false;
-        for (auto &rocket: rockets)
+        for (uint8_t index = 0; index < fireworks_settings::max_rockets; ++index)
         {
-            if (rocket.step( gravity))
+            auto &rocket = rockets[index];
+            if (rocket.step( settings, sparks))
             {
                 active = true;
-                rocket.render( display);
             }
-            else if (make_new)
+            else if (make_new and index < settings.rocket_count)
             {
-                rocket = random_rocket();
+                rocket = random_rocket( settings);
                 active = true;
             }
         }
 
-        return active;
+        sparks.step( settings.gravity);
+        return active or sparks.count();
+    }
+
+    void render( display_type &display) const
+    {
+        for (const auto &rocket: rockets)
+        {
+            rocket.render( display);
+        }
+        sparks.render( display);
     }
 
 private:
-    static rocket random_rocket()
+    static rocket random_rocket( const fireworks_settings &settings)
     {
         constexpr static int16_t vx_range = 8;
         constexpr static int8_t vy_range = 10;
         constexpr static uint8_t fuse_range = 110;
-        //constexpr static uint8_t trigger_range = 6;
         return
             {
                 static_cast<int16_t>( no_more_than( 8*matrix_count*16)), // x
                 static_cast<int16_t>( plusminus( vx_range)), // vx
                 static_cast<int8_t>(-(no_more_than( vy_range) + 8)), // vy, negative is up
                 static_cast<uint8_t>(no_more_than( fuse_range)), // fuse
-                //static_cast<int8_t>( no_more_than( trigger_range) - 2)
-                0
+                settings.trail_length
             };
 
     }
-    constexpr static uint8_t rocket_count = 5;
-    rocket rockets[rocket_count];
+
+    /// Room for a full burst of every rocket at once. A rocket that bursts
+    /// again before the sparks of its previous burst have fallen off the
+    /// display may find the particle system full, its extra sparks are dropped.
+    constexpr static uint8_t spark_capacity =
+            fireworks_settings::max_rockets * fireworks_settings::max_burst;
+
+    rocket rockets[fireworks_settings::max_rockets];
+    particle_system<spark_capacity, spark_config> sparks;
 } rockets;
 
 void setup_ws2811()
@@ -760,6 +1609,49 @@ void setup_ws2811()
     make_output( g.ws2811_signal);
 }
 
+/// Amount of leds that are sent to the ws2811 strip with interrupts disabled.
+///
+/// Every led takes 24 bits of 1.25us. The uart receive register holds one byte, so
+/// interrupts must be enabled at least once every byte time (10 bits at the configured
+/// baud rate) for the uart interrupt handler to pick up a received byte before the
+/// next one overwrites it. Half a byte time leaves enough room for the loop overhead and
+/// for the handler itself.
+constexpr uint8_t leds_per_segment = 16;
+static_assert(
+        leds_per_segment * 24UL * 125 / 100 < 1000000UL * 10 / uart_baud_rate / 2,
+        "sending a segment of leds takes too long for the uart baud rate");
+
+/**
+ * Send the led colors to the ws2811 strip without losing uart data.
+ *
+ * The strip is sent in segments with interrupts disabled. Interrupts are briefly
+ * enabled between the segments. This pause is much shorter than the time that the
+ * leds need to latch their colors, so the strip sees a single update.
+ */
+void send_leds()
+{
+    for (uint8_t first = 0; first < led_count; first += leds_per_segment)
+    {
+        const uint8_t count = min( led_count - first, leds_per_segment);
+        cli();
+        send( &g.leds[first], count * sizeof g.leds[0], ws2811_pin);
+        sei();
+    }
+}
+
+/// seed for the random generator, which changes on every start-up
+uint16_t random_seed EEMEM = 1;
+
+/**
+ * Seed the random generator from eeprom and store a new seed for the
+ * next start-up, so that the effects look different after every reset.
+ */
+void seed_random_from_eeprom()
+{
+    seed_random( eeprom_read_word( &random_seed));
+    eeprom_update_word( &random_seed, my_rand());
+}
+
 typedef water_torture::droplet<ws2811::rgb[led_count], true> droplet_type;
 constexpr uint8_t droplet_count = 3;
 droplet_type droplets[droplet_count]; // droplets that can animate simultaneously.
@@ -804,6 +1696,9 @@ int main()
 
     snowflakes_type<display_type> snowflakes;
 
+    glyphs.build();
+    seed_random_from_eeprom();
+
     make_output(led);
     display.auto_shift( false);
 
@@ -832,106 +1727,164 @@ int main()
     g.leds_changed = true;
 
     esp.execute( setup, &connected, nullptr, nullptr, &update);
-    auto next = Timer::After( Timer::ticksPerSecond/50);
     connected(nullptr, 0);
+
+    // every task runs at its own rate. The frame task executes queued
+    // commands and sends the display whenever anything on it has changed.
+    Timer::Periodic frame_task{ frame_ticks};
+    Timer::Periodic led_task{ frame_ticks};
+#ifdef WIFIMATRIX_PROFILE
+    // every five seconds, the stats of the phases are published one per frame.
+    Timer::Periodic stats_task{ 5 * Timer::ticksPerSecond};
+    uint8_t stats_phase = profiling::PhaseCount + 1;
+#endif
+
+    using profiling::Receive;
+    using profiling::TransmitStep;
+    using profiling::Leds;
+    using profiling::LedSend;
+    using profiling::Flush;
+    using profiling::Text;
+    using profiling::SnowStep;
+    using profiling::SnowRender;
+    using profiling::FireworksStep;
+    using profiling::FireworksRender;
+
     for (;;)
     {
-        while (not HasPassed(next))
         {
+            frame_profiler::scope s{ profiler, Receive};
             esp.try_receive();
         }
-        next = Timer::After( Timer::ticksPerSecond/50);
 
-        if (g.do_droplets)
         {
-            droplet_animate(g.leds);
-            g.leds_changed = true;
+            frame_profiler::scope s{ profiler, TransmitStep};
+            display.transmit_step();
         }
-        else
+
+        const auto now = Timer::GetTicks();
+
+        if (led_task.IsDue( now))
         {
-            for (auto &flare : g.flares)
+            frame_profiler::scope s{ profiler, Leds};
+            if (g.do_droplets)
+            {
+                droplet_animate(g.leds);
+                g.leds_changed = true;
+            }
+            else
             {
-                flare.step();
-                if (flare.render( g.leds))
+                // flares are drawn over the timeline.
+                if (g.timeline.step( g.leds))
+                {
+                    g.leds_changed = true;
+                }
+                if (g.flares.update( g.leds))
                 {
                     g.leds_changed = true;
                 }
             }
+
+            if (g.leds_changed)
+            {
+                frame_profiler::scope s{ profiler, LedSend};
+                send_leds();
+                g.leds_changed = false;
+            }
         }
 
-        if (g.leds_changed)
+        // implement flash
+        if (g.flash_task.IsDue( now))
         {
-            cli();
-            send( g.leds, ws2811_pin);
-            sei();
-            g.leds_changed = false;
+            display.enable( g.displayIsOn);
+            g.displayIsOn = not g.displayIsOn;
         }
 
-        // implement flash
-        if (g.flashCounter)
+        // implement scroll, but not while the cache holds a text that is not shown yet.
+        if (not g.show_pending and g.scroll_task.IsDue( now))
         {
-            if (not --g.flashCounter)
-            {
-                g.flashCounter = g.flashSpeed;
-                display.enable( g.displayIsOn);
-                g.displayIsOn = not g.displayIsOn;
-            }
+            scroller.step();
+            g.display_changed = true;
         }
 
-        // if one of the animations is active, render text.
-        bool do_render = g.snowflakes_active or g.fireworks_active;
+        if (g.snowflakes_active and g.snow_task.IsDue( now))
+        {
+            frame_profiler::scope s{ profiler, SnowStep};
+            g.snowflakes_active = snowflakes.step( g.do_snowflakes);
+            g.display_changed = true;
+        }
 
-        // implement scroll
-        if (g.do_scroll)
+        if (g.fireworks_active and g.fireworks_task.IsDue( now))
         {
-            g.wait_accumulator += g.wait_step;
-            if (g.wait_accumulator >= g.wait_threshold)
-            {
-                g.wait_accumulator -= g.wait_threshold;
-                --g.text_offset;
-                do_render = true;
-            }
+            frame_profiler::scope s{ profiler, FireworksStep};
+            g.fireworks_active = rockets.step( g.do_fireworks, g.fireworks);
+            g.display_changed = true;
         }
 
-        if (do_render)
+        if (frame_task.IsDue( now))
         {
-            // render text to display.
-            display.clear();
-            auto columns_rendered = render_string( g.text_buffer, g.text_offset);
+            profiler.frame_started( frame_ticks);
+            for (uint8_t budget = g.commands_per_frame; budget; --budget)
+            {
+                command c;
+                if (not g.commands.pop( c)) break;
+                execute( c);
+            }
 
-            // as the string is scrolling off to the left, we need to draw the start
-            // of the string on the right again.
+            if (g.ack_pending)
+            {
+                publish_ack();
+            }
 
-            // add some space between the end of the string and the start of the
-            // repeated string.
-            static constexpr auto repeat_space = 6;
-            if (g.do_scroll and columns_rendered < display_type::column_count + repeat_space)
+            if (g.display_changed and not g.show_pending)
             {
-                for (uint8_t count = repeat_space; count; --count)
+                g.display_changed = false;
+
                 {
-                    display.push_column( 0);
+                    frame_profiler::scope s{ profiler, Flush};
+                    display.flush();
                 }
-                render_string( g.text_buffer, 0);
-                if (columns_rendered == 0)
+
                 {
-                    g.text_offset = repeat_space;
+                    // render text to display.
+                    frame_profiler::scope s{ profiler, Text};
+                    display.clear();
+                    if (g.do_scroll)
+                    {
+                        scroller.render( display);
+                    }
+                    else
+                    {
+                        text_columns.render( display);
+                    }
                 }
-            }
-        }
 
-        if (g.snowflakes_active)
-        {
-            g.snowflakes_active = snowflakes.render( display, g.do_snowflakes);
-        }
+                if (g.snowflakes_active)
+                {
+                    frame_profiler::scope s{ profiler, SnowRender};
+                    snowflakes.render( display);
+                }
 
-        if (g.fireworks_active)
-        {
-            g.fireworks_active = rockets.render( display, g.do_fireworks);
-        }
+                if (g.fireworks_active)
+                {
+                    frame_profiler::scope s{ profiler, FireworksRender};
+                    rockets.render( display);
+                }
 
-        if (do_render)
-        {
-            display.transmit();
+                // the frame is sent while waiting for the next one.
+                display.start_transmit();
+            }
+
+#ifdef WIFIMATRIX_PROFILE
+            if (stats_task.IsDue( now))
+            {
+                stats_phase = 0;
+            }
+            if (stats_phase <= profiling::PhaseCount)
+            {
+                publish_stats( stats_phase++);
+            }
+#endif
         }
     }
 }